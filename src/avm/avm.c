@@ -25,21 +25,32 @@ void avm_free(AVM vm)
 {
     if (vm != NULL)
     {
-        if (vm->runtime.acc)
+        uint32_t i;
+        for (i=0;i<AVM_REGISTERS;++i)
         {
-            avm_object_free(vm,vm->runtime.acc);
-            vm->runtime.acc = NULL;
+            _avm_value_free(vm,vm->runtime.regs[i]);
+            vm->runtime.regs[i] = AVM_VALUE_NULL;
         }
         
         if (vm->runtime.vars)
         {
-            avm_dict_free(vm->runtime.vars);
+            _avm_dict_free(vm, vm->runtime.vars);
             vm->runtime.vars = NULL;
         }
         
-        if (vm->integer_pool)
+        free(vm->runtime.frames);
+        free(vm->runtime.locals.slots);
+        free(vm->runtime.saved.ptr);
+
+        avm_object_free(vm, (AVMObject)vm->program);
+        avm_object_free(vm, (AVMObject)vm->verified.code);
+
+        _avm_profile_free(vm->profile);
+        _avm_native_free(vm->natives);
+
+        if (vm->pool)
         {
-            avm_pool_free(vm->integer_pool);
+            avm_pool_free(vm->pool);
         }
 
         free(vm);
@@ -97,27 +108,57 @@ uint32_t avm_stats_icount(AVM vm)
     return vm->icount;
 }
 
-AVMError avm_tune(AVM vm, uint32_t integer_pool_size)
+AVMError avm_tune(AVM vm, uint32_t pool_size)
 {
-    if (vm->integer_pool)
+    return avm_tune_pool(vm, pool_size, AVM_POOL_DEFAULT_MAX_BLOCK);
+}
+
+AVMError avm_tune_pool(AVM vm, uint32_t blocks_per_class, uint32_t max_block_size)
+{
+    if (vm->pool)
     {
-        avm_pool_free(vm->integer_pool);
+        avm_pool_free(vm->pool);
     }
     
-    if (integer_pool_size)
+    if (blocks_per_class && max_block_size)
     {
-        vm->integer_pool = avm_pool_init(integer_pool_size);
-        if (!vm->integer_pool)
+        vm->pool = avm_pool_init(blocks_per_class, max_block_size);
+        if (!vm->pool)
             return AVM_ERROR_NO_MEM;
     }
     else
     {
-        vm->integer_pool = 0;
+        vm->pool = 0;
     }
 
     return AVM_NO_ERROR;
 }
 
+uint32_t avm_stats_pool(AVM vm, AVMPoolStats *stats, uint32_t n)
+{
+    AVMPool  p = vm->pool;
+    uint32_t i;
+
+    if (!p)
+        return 0;
+
+    for (i=0;i<n && i<p->nclasses;++i)
+    {
+        stats[i].block_size = AVM_POOL_CLASS_SIZE(i);
+        stats[i].cached     = p->c[i].cached;
+        stats[i].hits       = p->c[i].hits;
+        stats[i].misses     = p->c[i].misses;
+    }
+
+    return p->nclasses;
+}
+
+void avm_stats_cache(AVM vm, AVMCacheStats *stats)
+{
+    stats->hits   = vm->cache_hits;
+    stats->misses = vm->cache_misses;
+}
+
 AVMError avm_set_var(AVM vm, AVMHash key, AVMObject value)
 {
     AVMDict dict = vm->runtime.vars;
@@ -132,7 +173,7 @@ AVMError avm_set_var(AVM vm, AVMHash key, AVMObject value)
         vm->runtime.vars = dict;
     }
     
-    return avm_dict_set(dict, key, value);
+    return _avm_dict_set(vm, dict, key, value);
 }
 
 AVMError avm_set_var_by_name(AVM vm, const char *name, AVMObject value)
@@ -33,7 +33,11 @@
 #define AVM_ERROR_CHAR_VALUE     0x010d
 #define AVM_ERROR_MARK_NOT_FOUND 0x010e
 #define AVM_ERROR_STRING_RANGE   0x010f
-#define AVM_ERROR_ACC_NOT_SET    0x0110
+#define AVM_ERROR_ACC_NOT_SET    0x0110 // accumulator or register
+#define AVM_ERROR_CALL_DEPTH     0x0111
+#define AVM_ERROR_JUMP_RANGE     0x0112
+#define AVM_ERROR_LOCAL_NOT_SET  0x0113
+#define AVM_ERROR_BAD_ENCODING   0x0114 // not base64 or hex
 
 /* inconsistency errors 0x02xx */
 #define AVM_ERROR_INVALID_DISCARD 0x0200
@@ -46,6 +50,9 @@
 #define AVM_ERROR_TYPE_NOT_EXEC   0x0304
 #define AVM_ERROR_NEGATIVE_TIMES  0x0305
 
+/* registers R0..R15, R0 being the accumulator of aset/aget */
+#define AVM_REGISTERS 16
+
 typedef struct _AVM*      AVM;
 typedef struct _AVMStack* AVMStack;
 typedef struct _AVMDict*  AVMDict;
@@ -61,6 +68,7 @@ typedef enum {
     AVMTypeRef,
     AVMTypeMark,
     AVMTypeExternal,
+    AVMTypeBytes,
 } AVMType;
 
 typedef struct _AVMObject*  AVMObject;
@@ -70,11 +78,45 @@ typedef struct _AVMString*  AVMCode;
 typedef struct _AVMRef*     AVMRef;
 typedef struct _AVMMark*    AVMMark;
 typedef struct _AVMExternal* AVMExternal;
+typedef struct _AVMString*  AVMBytes;
 
 typedef AVMHash (* AVMHashFn) (const char *, size_t, AVMHash);
 
 typedef AVMError (* AVMExternalType) (AVM, AVMStack);
 
+typedef struct
+{
+    uint32_t block_size; /* bytes per block in this size class */
+    uint32_t cached;     /* blocks currently on the free list */
+    uint32_t hits;       /* allocations served from the free list */
+    uint32_t misses;     /* allocations that fell through to malloc */
+} AVMPoolStats;
+
+typedef struct
+{
+    uint32_t hits;   /* $name lookups answered by their inline cache */
+    uint32_t misses; /* lookups that went to the dict */
+} AVMCacheStats;
+
+#define AVM_PROFILE_MAX_NGRAM 7
+
+typedef struct
+{
+    uint8_t  length;                     /* opcodes in ops */
+    uint8_t  ops[AVM_PROFILE_MAX_NGRAM]; /* in the order they ran */
+    uint32_t count;
+} AVMNgramStats;
+
+typedef struct
+{
+    uint32_t blocks;  /* compiled by the JIT */
+    uint32_t bytes;   /* of machine code */
+    uint32_t natives; /* blocks found in loaded modules */
+} AVMJitStats;
+
+#define AVM_JIT_DEFAULT_THRESHOLD 100
+#define AVM_JIT_PERF_MAP          0x01 /* lists blocks in /tmp/perf-<pid>.map */
+
 /*
  * VM
  */
@@ -83,19 +125,62 @@ typedef AVMError (* AVMExternalType) (AVM, AVMStack);
     AVM  avm_init();
     void avm_free(AVM vm);
     
-    /* running */
+    /*
+     * running: the last program run is kept, so that running it again
+     * reuses what was decoded of it
+     */
     AVMError avm_run(AVM vm, 
                      const char *code, size_t size,
                      AVMStack s);
 
+    /*
+     * avm_verify checks a program once: opcodes, operand lengths, nested
+     * code and jump targets. avm_run_verified verifies its program (it
+     * remembers the last one) and runs it without per instruction bounds
+     * checks on operands.
+     */
+    AVMError avm_verify(AVM vm, const char *code, size_t size);
+    AVMError avm_run_verified(AVM vm,
+                              const char *code, size_t size,
+                              AVMStack s);
+
     /* tunning */
     void avm_set_hash_fn  (AVM vm, AVMHashFn h);
     void avm_set_hash_seed(AVM vm, AVMHash   seed);
-    AVMError avm_tune(AVM vm, uint32_t integer_pool_size);
+    AVMError avm_tune(AVM vm, uint32_t pool_size);
+    AVMError avm_tune_pool(AVM vm, uint32_t blocks_per_class,
+                                   uint32_t max_block_size);
 
     /* misc */
     uint16_t avm_version(AVM vm);
     uint32_t avm_stats_icount(AVM vm);
+    uint32_t avm_stats_pool(AVM vm, AVMPoolStats *stats, uint32_t n);
+    void     avm_stats_cache(AVM vm, AVMCacheStats *stats);
+
+    /*
+     * avm_profile counts the sequences of 2 to n opcodes run in a row
+     * (0 stops it); runs are slower meanwhile. avm_stats_ngrams fills the
+     * n most frequent ones and returns how many were seen.
+     */
+    AVMError avm_profile     (AVM vm, uint8_t n);
+    uint32_t avm_stats_ngrams(AVM vm, AVMNgramStats *stats, uint32_t n);
+
+    /*
+     * avm_jit compiles code blocks to machine code once they have started
+     * threshold times (0 turns it off). It is off until turned on, and only
+     * x86-64 Linux builds have a JIT, unless built with AVM_NO_JIT.
+     */
+    AVMError avm_jit      (AVM vm, uint32_t threshold, uint32_t flags);
+    void     avm_stats_jit(AVM vm, AVMJitStats *stats);
+
+    /*
+     * avm_load_native loads a shared object built from the C that avm2c
+     * translates a program to. Blocks of the programs run afterwards with
+     * the same bytes as one of its blocks run natively, rather than being
+     * interpreted or compiled. Unix builds with threaded dispatch have it,
+     * unless built with AVM_NO_NATIVE.
+     */
+    AVMError avm_load_native(AVM vm, const char *path);
     AVMHash avm_hash(AVM, const char*, size_t);
     
     /* vars */
@@ -118,13 +203,14 @@ typedef AVMError (* AVMExternalType) (AVM, AVMStack);
     AVMRef      avm_create_ref    (uint32_t hash);
     AVMMark     avm_create_mark   ();
     AVMExternal avm_create_external(AVMExternalType f);
+    AVMBytes    avm_create_bytes  (const char *data, uint32_t size);
 
     void        avm_object_free   (AVM vm, AVMObject o);
-    AVMObject   avm_object_copy   (AVMObject o);
+    AVMObject   avm_object_copy   (AVMObject o); /* strings and code are shared */
     AVMType     avm_object_type   (AVMObject o);
     int32_t     avm_integer_get   (AVMInteger o);
     uint32_t    avm_ref_get       (AVMRef o);
-    uint32_t    avm_string_length (AVMString o);
+    uint32_t    avm_string_length (AVMString o); /* of bytes as well */
     const char* avm_string_data   (AVMString o);
     /*
      * STACK
@@ -3,6 +3,163 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#   include <emmintrin.h>
+#endif
+
+/*
+ * Open addressing with one control byte per slot, probed a group at a
+ * time: the low 7 bits of the hash for a full slot, or EMPTY or DELETED.
+ * The first group of control bytes is mirrored past the end so that a
+ * group can be loaded from any slot. Groups are visited in triangular
+ * order, which reaches all of them as the size is a power of two.
+ */
+
+#define CTRL_EMPTY   0x80
+#define CTRL_DELETED 0xfe
+
+#define IS_FULL(C)   (!((C) & 0x80))
+
+/* grows once full and deleted slots pass 7/8 of the table */
+#define MAX_LOAD(SIZE) ((SIZE) - (SIZE)/8)
+
+static inline uint32_t _mix(AVMHash key)
+{
+    return key * 0x9e3779b1u;
+}
+
+#if defined(__SSE2__)
+
+static inline uint32_t _group_match(const uint8_t *ctrl, uint8_t c)
+{
+    __m128i g = _mm_loadu_si128((const __m128i*)ctrl);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)c)));
+}
+
+/* empty or deleted: the only control bytes with the high bit set */
+static inline uint32_t _group_free(const uint8_t *ctrl)
+{
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrl));
+}
+
+#else
+
+static inline uint32_t _group_match(const uint8_t *ctrl, uint8_t c)
+{
+    uint32_t i, m = 0;
+    for (i=0;i<AVM_DICT_GROUP;++i)
+    {
+        m |= (uint32_t)(ctrl[i] == c) << i;
+    }
+    return m;
+}
+
+static inline uint32_t _group_free(const uint8_t *ctrl)
+{
+    uint32_t i, m = 0;
+    for (i=0;i<AVM_DICT_GROUP;++i)
+    {
+        m |= (uint32_t)(ctrl[i] >> 7) << i;
+    }
+    return m;
+}
+
+#endif
+
+static inline uint32_t _lowest_bit(uint32_t m)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(m);
+#else
+    uint32_t i = 0;
+    while (!(m & 1))
+    {
+        m >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+static inline void _set_ctrl(AVMDict d, uint32_t i, uint8_t c)
+{
+    d->ctrl[i] = c;
+
+    if (i < AVM_DICT_GROUP)
+        d->ctrl[d->size + i] = c;
+}
+
+static char _alloc_table(AVMDict d, uint32_t size)
+{
+    uint8_t *ctrl = malloc(size + AVM_DICT_GROUP);
+    struct _AVMDictEntry *entries = malloc(size * sizeof(*entries));
+
+    if (!ctrl || !entries)
+    {
+        free(ctrl);
+        free(entries);
+        return 0;
+    }
+
+    memset(ctrl, CTRL_EMPTY, size + AVM_DICT_GROUP);
+
+    d->size       = size;
+    d->mask       = size - 1;
+    d->count      = 0;
+    d->tombstones = 0;
+    d->ctrl       = ctrl;
+    d->entries    = entries;
+
+    return 1;
+}
+
+/* first empty or deleted slot along the probe sequence of h */
+static uint32_t _find_free(AVMDict d, uint32_t h)
+{
+    uint32_t pos  = (h >> 7) & d->mask,
+             step = 0,
+             m;
+
+    while ( !(m = _group_free(&d->ctrl[pos])) )
+    {
+        step += AVM_DICT_GROUP;
+        pos   = (pos + step) & d->mask;
+    }
+
+    return (pos + _lowest_bit(m)) & d->mask;
+}
+
+static char _resize(AVMDict d, uint32_t size)
+{
+    uint8_t              *ctrl    = d->ctrl;
+    struct _AVMDictEntry *entries = d->entries;
+    uint32_t              count   = d->count,
+                          old     = d->size,
+                          i;
+
+    if (!_alloc_table(d, size))
+        return 0;
+
+    for (i=0;i<old;++i)
+    {
+        if (IS_FULL(ctrl[i]))
+        {
+            uint32_t h = _mix(entries[i].key),
+                     j = _find_free(d, h);
+
+            _set_ctrl(d, j, h & 0x7f);
+            d->entries[j] = entries[i];
+        }
+    }
+
+    d->count = count;
+    d->generation ++;
+
+    free(ctrl);
+    free(entries);
+
+    return 1;
+}
 
 AVMDict avm_dict_init(uint8_t size_exp)
 {
@@ -13,164 +170,155 @@ AVMDict avm_dict_init(uint8_t size_exp)
         size = size==0? AVM_DICT_DEFAULT_SIZE_EXP : AVM_DICT_MIN_SIZE_EXP;
     }
     else if (size > AVM_DICT_MAX_SIZE_EXP) size = AVM_DICT_MAX_SIZE_EXP;
-    
-    size = 1 << size;
-    
-    uint32_t extrasize = sizeof(struct _AVMDictEntry*) * size;
 
-    AVMDict o = ALLOC_OPAQUE_STRUCT_WITH_EXTRA(AVMDict,extrasize);
+    AVMDict o = ALLOC_OPAQUE_STRUCT(AVMDict);
 
     if (o != NULL)
     {
-        o->size  = size;
-        o->mask  = size - 1; 
-        //o->count = 0;
+        if (!_alloc_table(o, 1 << size))
+        {
+            free(o);
+            return NULL;
+        }
 
-        memset(&o->dict, 0, extrasize);
+        /* caches start at 0 so that they never match a dict */
+        o->generation = 1;
     }
 
     return o;
 }
 
-void avm_dict_free(AVMDict d)
+void _avm_dict_free(AVM vm, AVMDict d)
 {
     if (d)
     {
-        size_t pos;
-        for (pos=0;pos<d->size;++pos)
+        uint32_t i;
+        for (i=0;i<d->size;++i)
         {
-            struct _AVMDictEntry *e = d->dict[pos],
-                                 *next;
-
-            while (e)
+            if (IS_FULL(d->ctrl[i]) && d->entries[i].value)
             {
-                next = e->next;
-                if (e->value)
-                {
-                    avm_object_free(NULL,e->value);
-                }
-                free(e);
-                e = next;
+                avm_object_free(vm,d->entries[i].value);
             }
-
-            d->dict[pos] = 0;
         }
-        
+
+        free(d->ctrl);
+        free(d->entries);
         free(d);
     }
 }
 
+void avm_dict_free(AVMDict d)
+{
+    _avm_dict_free(NULL, d);
+}
 
-static AVMError _store_key(AVMHash key, AVMObject value,
-                           struct _AVMDictEntry **pPrev,
-                           struct _AVMDictEntry *next)
+struct _AVMDictEntry* _avm_dict_entry(AVMDict dict, AVMHash key)
 {
-    struct _AVMDictEntry *entry = malloc( sizeof(struct _AVMDictEntry) );
+    uint32_t h    = _mix(key),
+             pos  = (h >> 7) & dict->mask,
+             step = 0;
 
-    if (!entry)
+    for (;;)
     {
-        return AVM_ERROR_NO_MEM;
-    }
+        const uint8_t *group = &dict->ctrl[pos];
+        uint32_t       m     = _group_match(group, h & 0x7f);
+
+        while (m)
+        {
+            uint32_t i = (pos + _lowest_bit(m)) & dict->mask;
 
-    entry->key   = key;
-    entry->value = value;
-    entry->next  = next;
-    *pPrev       = entry;
+            if (dict->entries[i].key == key)
+                return &dict->entries[i];
 
-    return AVM_NO_ERROR;
+            m &= m - 1;
+        }
+
+        if (_group_match(group, CTRL_EMPTY))
+            return NULL;
+
+        step += AVM_DICT_GROUP;
+        pos   = (pos + step) & dict->mask;
+    }
 }
 
-AVMError avm_dict_set (AVMDict dict, AVMHash key, AVMObject value)
+AVMError _avm_dict_set(AVM vm, AVMDict dict, AVMHash key, AVMObject value)
 {
-    uint32_t pos = key & dict->mask;
-    struct _AVMDictEntry **ptr = & dict->dict[pos];
-    
-    if (!*ptr)
+    struct _AVMDictEntry *e = _avm_dict_entry(dict, key);
+
+    /* rebinding keeps the entry, and the caches pointing at it */
+    if (e != NULL)
     {
-        return _store_key(key, value, ptr, NULL);
+        if (e->value)
+            avm_object_free(vm,e->value);
+
+        e->value = value;
+
+        return AVM_NO_ERROR;
     }
-    else
-    {
-        struct _AVMDictEntry **prev = ptr;
-        struct _AVMDictEntry  *cur  = *ptr;
 
-        while (cur != NULL && cur->key < key)
-        {
-            prev = &cur->next;
-            cur  =  cur->next;
-        }
+    uint32_t h = _mix(key),
+             i = _find_free(dict, h);
 
-        if (cur != NULL)
-        {
-            if (cur->key == key)
-            {
-                if (cur->value)
-                    avm_object_free(NULL,cur->value);
-                
-                cur->value = value;
+    if (dict->ctrl[i] == CTRL_EMPTY
+     && dict->count + dict->tombstones + 1 > MAX_LOAD(dict->size))
+    {
+        /* mostly tombstones: clean them up in place */
+        uint32_t size = dict->count < dict->size/2? dict->size
+                                                   : dict->size * 2;
 
-                return AVM_NO_ERROR;
-            }
+        if (size == 0 || !_resize(dict, size))
+            return AVM_ERROR_NO_MEM;
 
-            return _store_key(key,value, prev, cur);
-        }
-        else
-        {
-            return _store_key(key, value, prev, NULL);
-        }
+        i = _find_free(dict, h);
     }
+
+    if (dict->ctrl[i] == CTRL_DELETED)
+        dict->tombstones --;
+
+    _set_ctrl(dict, i, h & 0x7f);
+    dict->entries[i].key   = key;
+    dict->entries[i].value = value;
+    dict->count ++;
+    dict->generation ++;
+
+    return AVM_NO_ERROR;
 }
 
-AVMError avm_dict_remove(AVMDict dict, AVMHash key)
+AVMError avm_dict_set(AVMDict dict, AVMHash key, AVMObject value)
 {
-    uint32_t pos = key & dict->mask;
-    struct _AVMDictEntry **ptr = & dict->dict[pos];
+    return _avm_dict_set(NULL, dict, key, value);
+}
 
-    if (*ptr)
-    {
-        struct _AVMDictEntry **prev = ptr;
-        struct _AVMDictEntry  *cur  = *ptr;
+AVMError _avm_dict_remove(AVM vm, AVMDict dict, AVMHash key)
+{
+    struct _AVMDictEntry *e = _avm_dict_entry(dict, key);
 
-        while (cur != NULL && cur->key < key)
-        {
-            prev = &cur->next;
-            cur  =  cur->next;
-        }
+    if (e != NULL)
+    {
+        if (e->value)
+            avm_object_free(vm,e->value);
 
-        if (cur != NULL)
-        {
-            if (cur->key == key)
-            {
-                if (cur->value)
-                    avm_object_free(NULL,cur->value);
-                
-                *prev = cur->next;
+        e->value = NULL;
 
-                free(cur);
-            }
-        }
+        _set_ctrl(dict, e - dict->entries, CTRL_DELETED);
+        dict->count --;
+        dict->tombstones ++;
+        dict->generation ++;
     }
 
     return AVM_NO_ERROR;
 }
 
+AVMError avm_dict_remove(AVMDict dict, AVMHash key)
+{
+    return _avm_dict_remove(NULL, dict, key);
+}
+
 AVMObject avm_dict_get(AVMDict dict, AVMHash key)
 {
     if (!dict) return NULL;
 
-    uint32_t pos = key & dict->mask;
-    struct _AVMDictEntry *ent = dict->dict[pos];
+    struct _AVMDictEntry *ent = _avm_dict_entry(dict, key);
 
-    while (ent != NULL && ent->key < key)
-    {
-        ent = ent->next;
-    }
-
-    if (ent && ent->key == key)
-    {
-        return ent->value;
-    }
-
-    return NULL;
+    return ent? ent->value : NULL;
 }
-
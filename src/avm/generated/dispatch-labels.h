@@ -0,0 +1,203 @@
+/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */
+
+/* included inside the threaded dispatch loop */
+
+AVM_THREADED_OP(Null)
+AVM_THREADED_OP(Mark)
+AVM_THREADED_OP(Debug)
+AVM_THREADED_OPERAND_OP(Ref)
+AVM_DECODED_OPERAND_OP(Ref,32)
+AVM_THREADED_CONTROL_OP(RefVal)
+AVM_DECODED_CONTROL_OP(RefVal,32)
+AVM_THREADED_OPERAND_OP(Int8)
+AVM_DECODED_OPERAND_OP(Int8,8)
+AVM_THREADED_OPERAND_OP(Int16)
+AVM_DECODED_OPERAND_OP(Int16,16)
+AVM_THREADED_OPERAND_OP(Int24)
+AVM_DECODED_OPERAND_OP(Int24,24)
+AVM_THREADED_OPERAND_OP(Int32)
+AVM_DECODED_OPERAND_OP(Int32,32)
+AVM_THREADED_OPERAND_OP(Str8)
+AVM_DECODED_OPERAND_OP(Str8,8)
+AVM_THREADED_OPERAND_OP(Str16)
+AVM_DECODED_OPERAND_OP(Str16,16)
+AVM_THREADED_OPERAND_OP(Code8)
+AVM_DECODED_OPERAND_OP(Code8,8)
+AVM_THREADED_OPERAND_OP(Code16)
+AVM_DECODED_OPERAND_OP(Code16,16)
+AVM_THREADED_OPERAND_OP(Code24)
+AVM_DECODED_OPERAND_OP(Code24,24)
+AVM_THREADED_OPERAND_OP(Code32)
+AVM_DECODED_OPERAND_OP(Code32,32)
+AVM_THREADED_OP(Add)
+AVM_THREADED_OP(Sub)
+AVM_THREADED_OP(Div)
+AVM_THREADED_OP(Mul)
+AVM_THREADED_OP(Mod)
+AVM_THREADED_OP(Not)
+AVM_THREADED_OP(Shl)
+AVM_THREADED_OP(Shr)
+AVM_THREADED_OP(And)
+AVM_THREADED_OP(Or)
+AVM_THREADED_OP(Inc)
+AVM_THREADED_OP(Dec)
+AVM_THREADED_OP(Def)
+AVM_THREADED_OP(Undef)
+AVM_THREADED_OP(ASet)
+AVM_THREADED_OP(AGet)
+AVM_THREADED_OPERAND_OP(LSet)
+AVM_DECODED_OPERAND_OP(LSet,8)
+AVM_THREADED_OPERAND_OP(LGet)
+AVM_DECODED_OPERAND_OP(LGet,8)
+AVM_THREADED_OPERAND_OP(LInc)
+AVM_DECODED_OPERAND_OP(LInc,8)
+AVM_THREADED_OPERAND_OP(RSet)
+AVM_DECODED_OPERAND_OP(RSet,8)
+AVM_THREADED_OPERAND_OP(RGet)
+AVM_DECODED_OPERAND_OP(RGet,8)
+AVM_THREADED_OPERAND_OP(RInc)
+AVM_DECODED_OPERAND_OP(RInc,8)
+AVM_THREADED_OP(Eq)
+AVM_THREADED_OP(Neq)
+AVM_THREADED_OP(Lt)
+AVM_THREADED_OP(Lte)
+AVM_THREADED_OP(Gt)
+AVM_THREADED_OP(Gte)
+AVM_THREADED_OP(IsMark)
+AVM_THREADED_OP(EqZ)
+AVM_THREADED_OP(NeqZ)
+AVM_THREADED_CONTROL_OP(If)
+AVM_THREADED_CONTROL_OP(IfElse)
+AVM_THREADED_CONTROL_OP(Repeat)
+AVM_THREADED_CONTROL_OP(For)
+AVM_THREADED_CONTROL_OP(Break)
+AVM_THREADED_OPERAND_OP(Jmp)
+AVM_DECODED_OPERAND_OP(Jmp,16)
+AVM_THREADED_OPERAND_OP(JmpZ)
+AVM_DECODED_OPERAND_OP(JmpZ,16)
+AVM_THREADED_OPERAND_OP(JmpNZ)
+AVM_DECODED_OPERAND_OP(JmpNZ,16)
+AVM_THREADED_CONTROL_OP(LoopRepeat)
+AVM_DECODED_CONTROL_OP(LoopRepeat,16)
+AVM_THREADED_CONTROL_OP(LoopFor)
+AVM_DECODED_CONTROL_OP(LoopFor,16)
+AVM_THREADED_OP(0)
+AVM_THREADED_OP(1)
+AVM_THREADED_OP(2)
+AVM_THREADED_OP(3)
+AVM_THREADED_OP(4)
+AVM_THREADED_OP(5)
+AVM_THREADED_OP(6)
+AVM_THREADED_OP(7)
+AVM_THREADED_OP(N1)
+AVM_THREADED_OP(N2)
+AVM_THREADED_OP(N3)
+AVM_THREADED_OP(N4)
+AVM_THREADED_OP(N5)
+AVM_THREADED_OP(N6)
+AVM_THREADED_OP(N7)
+AVM_THREADED_OP(At)
+AVM_THREADED_OP(Len)
+AVM_THREADED_OP(Head)
+AVM_THREADED_OP(Tail)
+AVM_THREADED_OP(Impl)
+AVM_THREADED_OP(Expl)
+AVM_THREADED_OP(Join)
+AVM_THREADED_OP(Split)
+AVM_THREADED_OP(B64Enc)
+AVM_THREADED_OP(B64Dec)
+AVM_THREADED_OP(HexEnc)
+AVM_THREADED_OP(HexDec)
+AVM_THREADED_OP(CRC32C)
+AVM_THREADED_OP(Find)
+AVM_THREADED_OP(Substr)
+AVM_THREADED_OP(JoinTM)
+AVM_THREADED_OP(Count)
+AVM_THREADED_OP(Times)
+AVM_THREADED_OP(Pop)
+AVM_THREADED_OP(Swap)
+AVM_THREADED_OP(Dup)
+AVM_THREADED_OP(Index)
+AVM_THREADED_OP(Roll)
+AVM_THREADED_OP(Copy)
+AVM_THREADED_OP(Rev)
+AVM_THREADED_OP(CTM)
+AVM_THREADED_OP(AccInc)
+AVM_THREADED_OP(Dup3Gt)
+AVM_THREADED_OP(DupUnder)
+AVM_THREADED_OP(SwapIsEven)
+AVM_THREADED_OP(Over2Lte)
+AVM_THREADED_OP(Bytes)
+AVM_THREADED_OP(BSet)
+AVM_THREADED_OP(BSlice)
+AVM_THREADED_OP(BApp)
+AVM_THREADED_OP(ToBytes)
+AVM_THREADED_OP(ToStr)
+AVM_THREADED_OP(invalid_opcode)
+
+AVM_QUICKENING_BEGIN(Add)
+AVM_QUICKENING_TRY(AddII,II)
+AVM_QUICKENING_END(Add)
+AVM_QUICK_OP(AddII,Add,II)
+
+AVM_QUICKENING_BEGIN(Sub)
+AVM_QUICKENING_TRY(SubII,II)
+AVM_QUICKENING_END(Sub)
+AVM_QUICK_OP(SubII,Sub,II)
+
+AVM_QUICKENING_BEGIN(Mul)
+AVM_QUICKENING_TRY(MulII,II)
+AVM_QUICKENING_END(Mul)
+AVM_QUICK_OP(MulII,Mul,II)
+
+AVM_QUICKENING_BEGIN(And)
+AVM_QUICKENING_TRY(AndII,II)
+AVM_QUICKENING_END(And)
+AVM_QUICK_OP(AndII,And,II)
+
+AVM_QUICKENING_BEGIN(Or)
+AVM_QUICKENING_TRY(OrII,II)
+AVM_QUICKENING_END(Or)
+AVM_QUICK_OP(OrII,Or,II)
+
+AVM_QUICKENING_BEGIN(Eq)
+AVM_QUICKENING_TRY(EqII,II)
+AVM_QUICKENING_TRY(EqSS,SS)
+AVM_QUICKENING_END(Eq)
+AVM_QUICK_OP(EqII,Eq,II)
+AVM_QUICK_OP(EqSS,Eq,SS)
+
+AVM_QUICKENING_BEGIN(Neq)
+AVM_QUICKENING_TRY(NeqII,II)
+AVM_QUICKENING_TRY(NeqSS,SS)
+AVM_QUICKENING_END(Neq)
+AVM_QUICK_OP(NeqII,Neq,II)
+AVM_QUICK_OP(NeqSS,Neq,SS)
+
+AVM_QUICKENING_BEGIN(Lt)
+AVM_QUICKENING_TRY(LtII,II)
+AVM_QUICKENING_TRY(LtSS,SS)
+AVM_QUICKENING_END(Lt)
+AVM_QUICK_OP(LtII,Lt,II)
+AVM_QUICK_OP(LtSS,Lt,SS)
+
+AVM_QUICKENING_BEGIN(Lte)
+AVM_QUICKENING_TRY(LteII,II)
+AVM_QUICKENING_TRY(LteSS,SS)
+AVM_QUICKENING_END(Lte)
+AVM_QUICK_OP(LteII,Lte,II)
+AVM_QUICK_OP(LteSS,Lte,SS)
+
+AVM_QUICKENING_BEGIN(Gt)
+AVM_QUICKENING_TRY(GtII,II)
+AVM_QUICKENING_TRY(GtSS,SS)
+AVM_QUICKENING_END(Gt)
+AVM_QUICK_OP(GtII,Gt,II)
+AVM_QUICK_OP(GtSS,Gt,SS)
+
+AVM_QUICKENING_BEGIN(Gte)
+AVM_QUICKENING_TRY(GteII,II)
+AVM_QUICKENING_TRY(GteSS,SS)
+AVM_QUICKENING_END(Gte)
+AVM_QUICK_OP(GteII,Gte,II)
+AVM_QUICK_OP(GteSS,Gte,SS)
@@ -0,0 +1,782 @@
+/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */
+
+/* included inside the threaded dispatch loop */
+
+static const void *DISPATCH_TABLE[256] = {
+    &&_op_Null,
+    &&_op_Mark,
+    &&_op_Debug,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_Ref,
+    &&_op_RefVal,
+    &&_op_Int8,
+    &&_op_Int16,
+    &&_op_Int24,
+    &&_op_Int32,
+    &&_op_Str8,
+    &&_op_Str16,
+    &&_op_Code8,
+    &&_op_Code16,
+    &&_op_Code24,
+    &&_op_Code32,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_Add,
+    &&_op_Sub,
+    &&_op_Div,
+    &&_op_Mul,
+    &&_op_Mod,
+    &&_op_Not,
+    &&_op_Shl,
+    &&_op_Shr,
+    &&_op_And,
+    &&_op_Or,
+    &&_op_Inc,
+    &&_op_Dec,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_Def,
+    &&_op_Undef,
+    &&_op_ASet,
+    &&_op_AGet,
+    &&_op_LSet,
+    &&_op_LGet,
+    &&_op_LInc,
+    &&_op_RSet,
+    &&_op_RGet,
+    &&_op_RInc,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_Eq,
+    &&_op_Neq,
+    &&_op_Lt,
+    &&_op_Lte,
+    &&_op_Gt,
+    &&_op_Gte,
+    &&_op_IsMark,
+    &&_op_EqZ,
+    &&_op_NeqZ,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_If,
+    &&_op_IfElse,
+    &&_op_Repeat,
+    &&_op_For,
+    &&_op_Break,
+    &&_op_Jmp,
+    &&_op_JmpZ,
+    &&_op_JmpNZ,
+    &&_op_LoopRepeat,
+    &&_op_LoopFor,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_0,
+    &&_op_1,
+    &&_op_2,
+    &&_op_3,
+    &&_op_4,
+    &&_op_5,
+    &&_op_6,
+    &&_op_7,
+    &&_op_N1,
+    &&_op_N2,
+    &&_op_N3,
+    &&_op_N4,
+    &&_op_N5,
+    &&_op_N6,
+    &&_op_N7,
+    &&_op_invalid_opcode,
+    &&_op_At,
+    &&_op_Len,
+    &&_op_Head,
+    &&_op_Tail,
+    &&_op_Impl,
+    &&_op_Expl,
+    &&_op_Join,
+    &&_op_Split,
+    &&_op_B64Enc,
+    &&_op_B64Dec,
+    &&_op_HexEnc,
+    &&_op_HexDec,
+    &&_op_CRC32C,
+    &&_op_Find,
+    &&_op_Substr,
+    &&_op_JoinTM,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_Count,
+    &&_op_Times,
+    &&_op_Pop,
+    &&_op_Swap,
+    &&_op_Dup,
+    &&_op_Index,
+    &&_op_Roll,
+    &&_op_Copy,
+    &&_op_Rev,
+    &&_op_CTM,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_AccInc,
+    &&_op_Dup3Gt,
+    &&_op_DupUnder,
+    &&_op_SwapIsEven,
+    &&_op_Over2Lte,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_Bytes,
+    &&_op_BSet,
+    &&_op_BSlice,
+    &&_op_BApp,
+    &&_op_ToBytes,
+    &&_op_ToStr,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+};
+
+/* handlers of decoded instructions */
+static const void *DECODED_TABLE[256] = {
+    &&_op_Null,
+    &&_op_Mark,
+    &&_op_Debug,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_dop_Ref,
+    &&_dop_RefVal,
+    &&_dop_Int8,
+    &&_dop_Int16,
+    &&_dop_Int24,
+    &&_dop_Int32,
+    &&_dop_Str8,
+    &&_dop_Str16,
+    &&_dop_Code8,
+    &&_dop_Code16,
+    &&_dop_Code24,
+    &&_dop_Code32,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_qop_Add,
+    &&_qop_Sub,
+    &&_op_Div,
+    &&_qop_Mul,
+    &&_op_Mod,
+    &&_op_Not,
+    &&_op_Shl,
+    &&_op_Shr,
+    &&_qop_And,
+    &&_qop_Or,
+    &&_op_Inc,
+    &&_op_Dec,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_Def,
+    &&_op_Undef,
+    &&_op_ASet,
+    &&_op_AGet,
+    &&_dop_LSet,
+    &&_dop_LGet,
+    &&_dop_LInc,
+    &&_dop_RSet,
+    &&_dop_RGet,
+    &&_dop_RInc,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_qop_Eq,
+    &&_qop_Neq,
+    &&_qop_Lt,
+    &&_qop_Lte,
+    &&_qop_Gt,
+    &&_qop_Gte,
+    &&_op_IsMark,
+    &&_op_EqZ,
+    &&_op_NeqZ,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_If,
+    &&_op_IfElse,
+    &&_op_Repeat,
+    &&_op_For,
+    &&_op_Break,
+    &&_dop_Jmp,
+    &&_dop_JmpZ,
+    &&_dop_JmpNZ,
+    &&_dop_LoopRepeat,
+    &&_dop_LoopFor,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_0,
+    &&_op_1,
+    &&_op_2,
+    &&_op_3,
+    &&_op_4,
+    &&_op_5,
+    &&_op_6,
+    &&_op_7,
+    &&_op_N1,
+    &&_op_N2,
+    &&_op_N3,
+    &&_op_N4,
+    &&_op_N5,
+    &&_op_N6,
+    &&_op_N7,
+    &&_op_invalid_opcode,
+    &&_op_At,
+    &&_op_Len,
+    &&_op_Head,
+    &&_op_Tail,
+    &&_op_Impl,
+    &&_op_Expl,
+    &&_op_Join,
+    &&_op_Split,
+    &&_op_B64Enc,
+    &&_op_B64Dec,
+    &&_op_HexEnc,
+    &&_op_HexDec,
+    &&_op_CRC32C,
+    &&_op_Find,
+    &&_op_Substr,
+    &&_op_JoinTM,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_Count,
+    &&_op_Times,
+    &&_op_Pop,
+    &&_op_Swap,
+    &&_op_Dup,
+    &&_op_Index,
+    &&_op_Roll,
+    &&_op_Copy,
+    &&_op_Rev,
+    &&_op_CTM,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_AccInc,
+    &&_op_Dup3Gt,
+    &&_op_DupUnder,
+    &&_op_SwapIsEven,
+    &&_op_Over2Lte,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_Bytes,
+    &&_op_BSet,
+    &&_op_BSlice,
+    &&_op_BApp,
+    &&_op_ToBytes,
+    &&_op_ToStr,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+};
+
+/* decoded instructions of verified code skip bounds checks */
+static const void *VERIFIED_TABLE[256] = {
+    &&_op_Null,
+    &&_op_Mark,
+    &&_op_Debug,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_vop_Ref,
+    &&_vop_RefVal,
+    &&_vop_Int8,
+    &&_vop_Int16,
+    &&_vop_Int24,
+    &&_vop_Int32,
+    &&_vop_Str8,
+    &&_vop_Str16,
+    &&_vop_Code8,
+    &&_vop_Code16,
+    &&_vop_Code24,
+    &&_vop_Code32,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_qop_Add,
+    &&_qop_Sub,
+    &&_op_Div,
+    &&_qop_Mul,
+    &&_op_Mod,
+    &&_op_Not,
+    &&_op_Shl,
+    &&_op_Shr,
+    &&_qop_And,
+    &&_qop_Or,
+    &&_op_Inc,
+    &&_op_Dec,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_Def,
+    &&_op_Undef,
+    &&_op_ASet,
+    &&_op_AGet,
+    &&_vop_LSet,
+    &&_vop_LGet,
+    &&_vop_LInc,
+    &&_vop_RSet,
+    &&_vop_RGet,
+    &&_vop_RInc,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_qop_Eq,
+    &&_qop_Neq,
+    &&_qop_Lt,
+    &&_qop_Lte,
+    &&_qop_Gt,
+    &&_qop_Gte,
+    &&_op_IsMark,
+    &&_op_EqZ,
+    &&_op_NeqZ,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_If,
+    &&_op_IfElse,
+    &&_op_Repeat,
+    &&_op_For,
+    &&_op_Break,
+    &&_vop_Jmp,
+    &&_vop_JmpZ,
+    &&_vop_JmpNZ,
+    &&_vop_LoopRepeat,
+    &&_vop_LoopFor,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_0,
+    &&_op_1,
+    &&_op_2,
+    &&_op_3,
+    &&_op_4,
+    &&_op_5,
+    &&_op_6,
+    &&_op_7,
+    &&_op_N1,
+    &&_op_N2,
+    &&_op_N3,
+    &&_op_N4,
+    &&_op_N5,
+    &&_op_N6,
+    &&_op_N7,
+    &&_op_invalid_opcode,
+    &&_op_At,
+    &&_op_Len,
+    &&_op_Head,
+    &&_op_Tail,
+    &&_op_Impl,
+    &&_op_Expl,
+    &&_op_Join,
+    &&_op_Split,
+    &&_op_B64Enc,
+    &&_op_B64Dec,
+    &&_op_HexEnc,
+    &&_op_HexDec,
+    &&_op_CRC32C,
+    &&_op_Find,
+    &&_op_Substr,
+    &&_op_JoinTM,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_Count,
+    &&_op_Times,
+    &&_op_Pop,
+    &&_op_Swap,
+    &&_op_Dup,
+    &&_op_Index,
+    &&_op_Roll,
+    &&_op_Copy,
+    &&_op_Rev,
+    &&_op_CTM,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_AccInc,
+    &&_op_Dup3Gt,
+    &&_op_DupUnder,
+    &&_op_SwapIsEven,
+    &&_op_Over2Lte,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_Bytes,
+    &&_op_BSet,
+    &&_op_BSlice,
+    &&_op_BApp,
+    &&_op_ToBytes,
+    &&_op_ToStr,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+    &&_op_invalid_opcode,
+};
@@ -0,0 +1,265 @@
+#ifndef OPCODE_INFO_H_INCLUDED
+#define OPCODE_INFO_H_INCLUDED
+
+/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */
+
+static const AVMOpcodeInfo OPCODE_INFO[256] = {
+    {1, -1, -1, 0, AVMOperandNone, 0}, /* Null */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* Mark */
+    {1, 0, 0, 0, AVMOperandNone, 0}, /* Debug */
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {1, 0, 1, 4, AVMOperandValue, 0}, /* Ref */
+    {1, -1, -1, 4, AVMOperandValue, 1}, /* RefVal */
+    {1, 0, 1, 1, AVMOperandInteger, 0}, /* Int8 */
+    {1, 0, 1, 2, AVMOperandInteger, 0}, /* Int16 */
+    {1, 0, 1, 3, AVMOperandInteger, 0}, /* Int24 */
+    {1, 0, 1, 4, AVMOperandInteger, 0}, /* Int32 */
+    {1, 0, 1, 1, AVMOperandBlob, 0}, /* Str8 */
+    {1, 0, 1, 2, AVMOperandBlob, 0}, /* Str16 */
+    {1, 0, 1, 1, AVMOperandCode, 0}, /* Code8 */
+    {1, 0, 1, 2, AVMOperandCode, 0}, /* Code16 */
+    {1, 0, 1, 3, AVMOperandCode, 0}, /* Code24 */
+    {1, 0, 1, 4, AVMOperandCode, 0}, /* Code32 */
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Add */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Sub */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Div */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Mul */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Mod */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* Not */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Shl */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Shr */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* And */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Or */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* Inc */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* Dec */
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {1, 2, 0, 0, AVMOperandNone, 0}, /* Def */
+    {1, 1, 0, 0, AVMOperandNone, 0}, /* Undef */
+    {1, 1, 0, 0, AVMOperandNone, 0}, /* ASet */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* AGet */
+    {1, 1, 0, 1, AVMOperandSlot, 0}, /* LSet */
+    {1, 0, 1, 1, AVMOperandSlot, 0}, /* LGet */
+    {1, 0, 0, 1, AVMOperandSlot, 0}, /* LInc */
+    {1, 1, 0, 1, AVMOperandSlot, 0}, /* RSet */
+    {1, 0, 1, 1, AVMOperandSlot, 0}, /* RGet */
+    {1, 0, 0, 1, AVMOperandSlot, 0}, /* RInc */
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Eq */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Neq */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Lt */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Lte */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Gt */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Gte */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* IsMark */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* EqZ */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* NeqZ */
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {1, -1, -1, 0, AVMOperandNone, 1}, /* If */
+    {1, -1, -1, 0, AVMOperandNone, 1}, /* IfElse */
+    {1, -1, -1, 0, AVMOperandNone, 1}, /* Repeat */
+    {1, -1, -1, 0, AVMOperandNone, 1}, /* For */
+    {1, -1, -1, 0, AVMOperandNone, 1}, /* Break */
+    {1, -1, -1, 2, AVMOperandJump, 0}, /* Jmp */
+    {1, -1, -1, 2, AVMOperandJump, 0}, /* JmpZ */
+    {1, -1, -1, 2, AVMOperandJump, 0}, /* JmpNZ */
+    {1, -1, -1, 2, AVMOperandLoop, 1}, /* LoopRepeat */
+    {1, -1, -1, 2, AVMOperandLoop, 1}, /* LoopFor */
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* 0 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* 1 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* 2 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* 3 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* 4 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* 5 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* 6 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* 7 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* N1 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* N2 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* N3 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* N4 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* N5 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* N6 */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* N7 */
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* At */
+    {1, 1, 2, 0, AVMOperandNone, 0}, /* Len */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* Head */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* Tail */
+    {1, -1, -1, 0, AVMOperandNone, 0}, /* Impl */
+    {1, 1, 0, 0, AVMOperandNone, 0}, /* Expl */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* Join */
+    {1, 2, 2, 0, AVMOperandNone, 0}, /* Split */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* B64Enc */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* B64Dec */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* HexEnc */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* HexDec */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* CRC32C */
+    {1, 2, 2, 0, AVMOperandNone, 0}, /* Find */
+    {1, 3, 1, 0, AVMOperandNone, 0}, /* Substr */
+    {1, -1, -1, 0, AVMOperandNone, 0}, /* JoinTM */
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* Count */
+    {1, 2, 0, 0, AVMOperandNone, 0}, /* Times */
+    {1, 1, 0, 0, AVMOperandNone, 0}, /* Pop */
+    {1, 2, 2, 0, AVMOperandNone, 0}, /* Swap */
+    {1, 1, 2, 0, AVMOperandNone, 0}, /* Dup */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* Index */
+    {1, 2, 0, 0, AVMOperandNone, 0}, /* Roll */
+    {1, 1, 0, 0, AVMOperandNone, 0}, /* Copy */
+    {1, 1, 0, 0, AVMOperandNone, 0}, /* Rev */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* CTM */
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {1, 0, 0, 0, AVMOperandNone, 0}, /* AccInc */
+    {1, 1, 2, 0, AVMOperandNone, 0}, /* Dup3Gt */
+    {1, 0, 1, 0, AVMOperandNone, 0}, /* DupUnder */
+    {1, 2, 2, 0, AVMOperandNone, 0}, /* SwapIsEven */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* Over2Lte */
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* Bytes */
+    {1, 3, 1, 0, AVMOperandNone, 0}, /* BSet */
+    {1, 3, 1, 0, AVMOperandNone, 0}, /* BSlice */
+    {1, 2, 1, 0, AVMOperandNone, 0}, /* BApp */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* ToBytes */
+    {1, 1, 1, 0, AVMOperandNone, 0}, /* ToStr */
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+    {0, 0, 0, 0, AVMOperandNone, 0},
+};
+
+#endif // OPCODE_INFO_H_INCLUDED
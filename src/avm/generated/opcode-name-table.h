@@ -0,0 +1,108 @@
+#ifndef OPCODE_NAME_TABLE_H_INCLUDED
+#define OPCODE_NAME_TABLE_H_INCLUDED
+
+/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */
+
+static struct {
+    const char *name;
+    AVMOpcode   op;
+}
+OPCODE_TABLE[] = {
+    {"mark", AVMOpcodeMark},
+    {"debug", AVMOpcodeDebug},
+    {"add", AVMOpcodeAdd},
+    {"sub", AVMOpcodeSub},
+    {"div", AVMOpcodeDiv},
+    {"mul", AVMOpcodeMul},
+    {"mod", AVMOpcodeMod},
+    {"rem", AVMOpcodeMod},
+    {"not", AVMOpcodeNot},
+    {"shl", AVMOpcodeShl},
+    {"shr", AVMOpcodeShr},
+    {"and", AVMOpcodeAnd},
+    {"or", AVMOpcodeOr},
+    {"inc", AVMOpcodeInc},
+    {"dec", AVMOpcodeDec},
+    {"def", AVMOpcodeDef},
+    {"undef", AVMOpcodeUndef},
+    {"aset", AVMOpcodeASet},
+    {"aget", AVMOpcodeAGet},
+    {"lset", AVMOpcodeLSet},
+    {"lget", AVMOpcodeLGet},
+    {"linc", AVMOpcodeLInc},
+    {"rset", AVMOpcodeRSet},
+    {"rget", AVMOpcodeRGet},
+    {"rinc", AVMOpcodeRInc},
+    {"eq", AVMOpcodeEq},
+    {"neq", AVMOpcodeNeq},
+    {"lt", AVMOpcodeLt},
+    {"lte", AVMOpcodeLte},
+    {"gt", AVMOpcodeGt},
+    {"gte", AVMOpcodeGte},
+    {"ismark", AVMOpcodeIsMark},
+    {"eqz", AVMOpcodeEqZ},
+    {"eqzero", AVMOpcodeEqZ},
+    {"neqz", AVMOpcodeNeqZ},
+    {"neqzero", AVMOpcodeNeqZ},
+    {"if", AVMOpcodeIf},
+    {"ifelse", AVMOpcodeIfElse},
+    {"repeat", AVMOpcodeRepeat},
+    {"for", AVMOpcodeFor},
+    {"break", AVMOpcodeBreak},
+    {"at", AVMOpcodeAt},
+    {"len", AVMOpcodeLen},
+    {"length", AVMOpcodeLen},
+    {"head", AVMOpcodeHead},
+    {"tail", AVMOpcodeTail},
+    {"impl", AVMOpcodeImpl},
+    {"implode", AVMOpcodeImpl},
+    {"expl", AVMOpcodeExpl},
+    {"explode", AVMOpcodeExpl},
+    {"join", AVMOpcodeJoin},
+    {"split", AVMOpcodeSplit},
+    {"base64", AVMOpcodeB64Enc},
+    {"b64enc", AVMOpcodeB64Enc},
+    {"unbase64", AVMOpcodeB64Dec},
+    {"b64dec", AVMOpcodeB64Dec},
+    {"hex", AVMOpcodeHexEnc},
+    {"hexenc", AVMOpcodeHexEnc},
+    {"unhex", AVMOpcodeHexDec},
+    {"hexdec", AVMOpcodeHexDec},
+    {"crc32c", AVMOpcodeCRC32C},
+    {"find", AVMOpcodeFind},
+    {"search", AVMOpcodeFind},
+    {"substr", AVMOpcodeSubstr},
+    {"jointomark", AVMOpcodeJoinTM},
+    {"jtm", AVMOpcodeJoinTM},
+    {"count", AVMOpcodeCount},
+    {"times", AVMOpcodeTimes},
+    {"pop", AVMOpcodePop},
+    {"swap", AVMOpcodeSwap},
+    {"exch", AVMOpcodeSwap},
+    {"dup", AVMOpcodeDup},
+    {"index", AVMOpcodeIndex},
+    {"roll", AVMOpcodeRoll},
+    {"rot", AVMOpcodeRoll},
+    {"rol", AVMOpcodeRoll},
+    {"rotate", AVMOpcodeRoll},
+    {"copy", AVMOpcodeCopy},
+    {"cp", AVMOpcodeCopy},
+    {"rev", AVMOpcodeRev},
+    {"reverse", AVMOpcodeRev},
+    {"inverse", AVMOpcodeRev},
+    {"inv", AVMOpcodeRev},
+    {"counttomark", AVMOpcodeCTM},
+    {"ctm", AVMOpcodeCTM},
+    {"bytes", AVMOpcodeBytes},
+    {"bset", AVMOpcodeBSet},
+    {"bput", AVMOpcodeBSet},
+    {"bslice", AVMOpcodeBSlice},
+    {"bappend", AVMOpcodeBApp},
+    {"bapp", AVMOpcodeBApp},
+    {"tobytes", AVMOpcodeToBytes},
+    {"tostr", AVMOpcodeToStr},
+    {"tostring", AVMOpcodeToStr},
+    {NULL, 0}
+};
+
+#endif // OPCODE_NAME_TABLE_H_INCLUDED
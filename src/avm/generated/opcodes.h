@@ -0,0 +1,119 @@
+#ifndef OPCODES_H_INCLUDED
+#define OPCODES_H_INCLUDED
+
+/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */
+
+typedef enum
+{
+AVMOpcodeNull             = 0x00,
+AVMOpcodeMark             = 0x01,
+AVMOpcodeDebug            = 0x02,
+AVMOpcodeRef              = 0x10,
+AVMOpcodeRefVal           = 0x11,
+AVMOpcodeInt8             = 0x12,
+AVMOpcodeInt16            = 0x13,
+AVMOpcodeInt24            = 0x14,
+AVMOpcodeInt32            = 0x15,
+AVMOpcodeStr8             = 0x16,
+AVMOpcodeStr16            = 0x17,
+AVMOpcodeCode8            = 0x18,
+AVMOpcodeCode16           = 0x19,
+AVMOpcodeCode24           = 0x1a,
+AVMOpcodeCode32           = 0x1b,
+AVMOpcodeAdd              = 0x20,
+AVMOpcodeSub              = 0x21,
+AVMOpcodeDiv              = 0x22,
+AVMOpcodeMul              = 0x23,
+AVMOpcodeMod              = 0x24,
+AVMOpcodeNot              = 0x25,
+AVMOpcodeShl              = 0x26,
+AVMOpcodeShr              = 0x27,
+AVMOpcodeAnd              = 0x28,
+AVMOpcodeOr               = 0x29,
+AVMOpcodeInc              = 0x2a,
+AVMOpcodeDec              = 0x2b,
+AVMOpcodeDef              = 0x30,
+AVMOpcodeUndef            = 0x31,
+AVMOpcodeASet             = 0x32,
+AVMOpcodeAGet             = 0x33,
+AVMOpcodeLSet             = 0x34,
+AVMOpcodeLGet             = 0x35,
+AVMOpcodeLInc             = 0x36,
+AVMOpcodeRSet             = 0x37,
+AVMOpcodeRGet             = 0x38,
+AVMOpcodeRInc             = 0x39,
+AVMOpcodeEq               = 0x40,
+AVMOpcodeNeq              = 0x41,
+AVMOpcodeLt               = 0x42,
+AVMOpcodeLte              = 0x43,
+AVMOpcodeGt               = 0x44,
+AVMOpcodeGte              = 0x45,
+AVMOpcodeIsMark           = 0x46,
+AVMOpcodeEqZ              = 0x47,
+AVMOpcodeNeqZ             = 0x48,
+AVMOpcodeIf               = 0x50,
+AVMOpcodeIfElse           = 0x51,
+AVMOpcodeRepeat           = 0x52,
+AVMOpcodeFor              = 0x53,
+AVMOpcodeBreak            = 0x54,
+AVMOpcodeJmp              = 0x55,
+AVMOpcodeJmpZ             = 0x56,
+AVMOpcodeJmpNZ            = 0x57,
+AVMOpcodeLoopRepeat       = 0x58,
+AVMOpcodeLoopFor          = 0x59,
+AVMOpcode0                = 0x60,
+AVMOpcode1                = 0x61,
+AVMOpcode2                = 0x62,
+AVMOpcode3                = 0x63,
+AVMOpcode4                = 0x64,
+AVMOpcode5                = 0x65,
+AVMOpcode6                = 0x66,
+AVMOpcode7                = 0x67,
+AVMOpcodeN1               = 0x68,
+AVMOpcodeN2               = 0x69,
+AVMOpcodeN3               = 0x6a,
+AVMOpcodeN4               = 0x6b,
+AVMOpcodeN5               = 0x6c,
+AVMOpcodeN6               = 0x6d,
+AVMOpcodeN7               = 0x6e,
+AVMOpcodeAt               = 0x70,
+AVMOpcodeLen              = 0x71,
+AVMOpcodeHead             = 0x72,
+AVMOpcodeTail             = 0x73,
+AVMOpcodeImpl             = 0x74,
+AVMOpcodeExpl             = 0x75,
+AVMOpcodeJoin             = 0x76,
+AVMOpcodeSplit            = 0x77,
+AVMOpcodeB64Enc           = 0x78,
+AVMOpcodeB64Dec           = 0x79,
+AVMOpcodeHexEnc           = 0x7a,
+AVMOpcodeHexDec           = 0x7b,
+AVMOpcodeCRC32C           = 0x7c,
+AVMOpcodeFind             = 0x7d,
+AVMOpcodeSubstr           = 0x7e,
+AVMOpcodeJoinTM           = 0x7f,
+AVMOpcodeCount            = 0x90,
+AVMOpcodeTimes            = 0x91,
+AVMOpcodePop              = 0x92,
+AVMOpcodeSwap             = 0x93,
+AVMOpcodeDup              = 0x94,
+AVMOpcodeIndex            = 0x95,
+AVMOpcodeRoll             = 0x96,
+AVMOpcodeCopy             = 0x97,
+AVMOpcodeRev              = 0x98,
+AVMOpcodeCTM              = 0x99,
+AVMOpcodeAccInc           = 0xa0,
+AVMOpcodeDup3Gt           = 0xa1,
+AVMOpcodeDupUnder         = 0xa2,
+AVMOpcodeSwapIsEven       = 0xa3,
+AVMOpcodeOver2Lte         = 0xa4,
+AVMOpcodeBytes            = 0xb0,
+AVMOpcodeBSet             = 0xb1,
+AVMOpcodeBSlice           = 0xb2,
+AVMOpcodeBApp             = 0xb3,
+AVMOpcodeToBytes          = 0xb4,
+AVMOpcodeToStr            = 0xb5,
+
+} AVMOpcode;
+
+#endif // OPCODES_H_INCLUDED
@@ -0,0 +1,265 @@
+#ifndef PARSER_TABLE_H_INCLUDED
+#define PARSER_TABLE_H_INCLUDED
+
+/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */
+
+AVMError ( *PARSER_TABLE[256] )(AVM) = {
+    _parse_Null,
+    _parse_Mark,
+    _parse_Debug,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_Ref,
+    _parse_RefVal,
+    _parse_Int8,
+    _parse_Int16,
+    _parse_Int24,
+    _parse_Int32,
+    _parse_Str8,
+    _parse_Str16,
+    _parse_Code8,
+    _parse_Code16,
+    _parse_Code24,
+    _parse_Code32,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_Add,
+    _parse_Sub,
+    _parse_Div,
+    _parse_Mul,
+    _parse_Mod,
+    _parse_Not,
+    _parse_Shl,
+    _parse_Shr,
+    _parse_And,
+    _parse_Or,
+    _parse_Inc,
+    _parse_Dec,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_Def,
+    _parse_Undef,
+    _parse_ASet,
+    _parse_AGet,
+    _parse_LSet,
+    _parse_LGet,
+    _parse_LInc,
+    _parse_RSet,
+    _parse_RGet,
+    _parse_RInc,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_Eq,
+    _parse_Neq,
+    _parse_Lt,
+    _parse_Lte,
+    _parse_Gt,
+    _parse_Gte,
+    _parse_IsMark,
+    _parse_EqZ,
+    _parse_NeqZ,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_If,
+    _parse_IfElse,
+    _parse_Repeat,
+    _parse_For,
+    _parse_Break,
+    _parse_Jmp,
+    _parse_JmpZ,
+    _parse_JmpNZ,
+    _parse_LoopRepeat,
+    _parse_LoopFor,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_0,
+    _parse_1,
+    _parse_2,
+    _parse_3,
+    _parse_4,
+    _parse_5,
+    _parse_6,
+    _parse_7,
+    _parse_N1,
+    _parse_N2,
+    _parse_N3,
+    _parse_N4,
+    _parse_N5,
+    _parse_N6,
+    _parse_N7,
+    _parse_invalid_opcode,
+    _parse_At,
+    _parse_Len,
+    _parse_Head,
+    _parse_Tail,
+    _parse_Impl,
+    _parse_Expl,
+    _parse_Join,
+    _parse_Split,
+    _parse_B64Enc,
+    _parse_B64Dec,
+    _parse_HexEnc,
+    _parse_HexDec,
+    _parse_CRC32C,
+    _parse_Find,
+    _parse_Substr,
+    _parse_JoinTM,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_Count,
+    _parse_Times,
+    _parse_Pop,
+    _parse_Swap,
+    _parse_Dup,
+    _parse_Index,
+    _parse_Roll,
+    _parse_Copy,
+    _parse_Rev,
+    _parse_CTM,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_AccInc,
+    _parse_Dup3Gt,
+    _parse_DupUnder,
+    _parse_SwapIsEven,
+    _parse_Over2Lte,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_Bytes,
+    _parse_BSet,
+    _parse_BSlice,
+    _parse_BApp,
+    _parse_ToBytes,
+    _parse_ToStr,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+    _parse_invalid_opcode,
+};
+
+#endif // PARSER_TABLE_H_INCLUDED
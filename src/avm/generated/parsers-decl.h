@@ -0,0 +1,117 @@
+#ifndef PARSERS_H_INCLUDED
+#define PARSERS_H_INCLUDED
+
+/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */
+
+static AVMError _parse_Null(AVM vm);
+static AVMError _parse_Mark(AVM vm);
+static AVMError _parse_Debug(AVM vm);
+static AVMError _parse_Ref(AVM vm);
+static AVMError _parse_RefVal(AVM vm);
+static AVMError _parse_Int8(AVM vm);
+static AVMError _parse_Int16(AVM vm);
+static AVMError _parse_Int24(AVM vm);
+static AVMError _parse_Int32(AVM vm);
+static AVMError _parse_Str8(AVM vm);
+static AVMError _parse_Str16(AVM vm);
+static AVMError _parse_Code8(AVM vm);
+static AVMError _parse_Code16(AVM vm);
+static AVMError _parse_Code24(AVM vm);
+static AVMError _parse_Code32(AVM vm);
+static AVMError _parse_Add(AVM vm);
+static AVMError _parse_Sub(AVM vm);
+static AVMError _parse_Div(AVM vm);
+static AVMError _parse_Mul(AVM vm);
+static AVMError _parse_Mod(AVM vm);
+static AVMError _parse_Not(AVM vm);
+static AVMError _parse_Shl(AVM vm);
+static AVMError _parse_Shr(AVM vm);
+static AVMError _parse_And(AVM vm);
+static AVMError _parse_Or(AVM vm);
+static AVMError _parse_Inc(AVM vm);
+static AVMError _parse_Dec(AVM vm);
+static AVMError _parse_Def(AVM vm);
+static AVMError _parse_Undef(AVM vm);
+static AVMError _parse_ASet(AVM vm);
+static AVMError _parse_AGet(AVM vm);
+static AVMError _parse_LSet(AVM vm);
+static AVMError _parse_LGet(AVM vm);
+static AVMError _parse_LInc(AVM vm);
+static AVMError _parse_RSet(AVM vm);
+static AVMError _parse_RGet(AVM vm);
+static AVMError _parse_RInc(AVM vm);
+static AVMError _parse_Eq(AVM vm);
+static AVMError _parse_Neq(AVM vm);
+static AVMError _parse_Lt(AVM vm);
+static AVMError _parse_Lte(AVM vm);
+static AVMError _parse_Gt(AVM vm);
+static AVMError _parse_Gte(AVM vm);
+static AVMError _parse_IsMark(AVM vm);
+static AVMError _parse_EqZ(AVM vm);
+static AVMError _parse_NeqZ(AVM vm);
+static AVMError _parse_If(AVM vm);
+static AVMError _parse_IfElse(AVM vm);
+static AVMError _parse_Repeat(AVM vm);
+static AVMError _parse_For(AVM vm);
+static AVMError _parse_Break(AVM vm);
+static AVMError _parse_Jmp(AVM vm);
+static AVMError _parse_JmpZ(AVM vm);
+static AVMError _parse_JmpNZ(AVM vm);
+static AVMError _parse_LoopRepeat(AVM vm);
+static AVMError _parse_LoopFor(AVM vm);
+static AVMError _parse_0(AVM vm);
+static AVMError _parse_1(AVM vm);
+static AVMError _parse_2(AVM vm);
+static AVMError _parse_3(AVM vm);
+static AVMError _parse_4(AVM vm);
+static AVMError _parse_5(AVM vm);
+static AVMError _parse_6(AVM vm);
+static AVMError _parse_7(AVM vm);
+static AVMError _parse_N1(AVM vm);
+static AVMError _parse_N2(AVM vm);
+static AVMError _parse_N3(AVM vm);
+static AVMError _parse_N4(AVM vm);
+static AVMError _parse_N5(AVM vm);
+static AVMError _parse_N6(AVM vm);
+static AVMError _parse_N7(AVM vm);
+static AVMError _parse_At(AVM vm);
+static AVMError _parse_Len(AVM vm);
+static AVMError _parse_Head(AVM vm);
+static AVMError _parse_Tail(AVM vm);
+static AVMError _parse_Impl(AVM vm);
+static AVMError _parse_Expl(AVM vm);
+static AVMError _parse_Join(AVM vm);
+static AVMError _parse_Split(AVM vm);
+static AVMError _parse_B64Enc(AVM vm);
+static AVMError _parse_B64Dec(AVM vm);
+static AVMError _parse_HexEnc(AVM vm);
+static AVMError _parse_HexDec(AVM vm);
+static AVMError _parse_CRC32C(AVM vm);
+static AVMError _parse_Find(AVM vm);
+static AVMError _parse_Substr(AVM vm);
+static AVMError _parse_JoinTM(AVM vm);
+static AVMError _parse_Count(AVM vm);
+static AVMError _parse_Times(AVM vm);
+static AVMError _parse_Pop(AVM vm);
+static AVMError _parse_Swap(AVM vm);
+static AVMError _parse_Dup(AVM vm);
+static AVMError _parse_Index(AVM vm);
+static AVMError _parse_Roll(AVM vm);
+static AVMError _parse_Copy(AVM vm);
+static AVMError _parse_Rev(AVM vm);
+static AVMError _parse_CTM(AVM vm);
+static AVMError _parse_AccInc(AVM vm);
+static AVMError _parse_Dup3Gt(AVM vm);
+static AVMError _parse_DupUnder(AVM vm);
+static AVMError _parse_SwapIsEven(AVM vm);
+static AVMError _parse_Over2Lte(AVM vm);
+static AVMError _parse_Bytes(AVM vm);
+static AVMError _parse_BSet(AVM vm);
+static AVMError _parse_BSlice(AVM vm);
+static AVMError _parse_BApp(AVM vm);
+static AVMError _parse_ToBytes(AVM vm);
+static AVMError _parse_ToStr(AVM vm);
+
+static AVMError _parse_invalid_opcode(AVM vm);
+
+#endif // PARSERS_H_INCLUDED
@@ -0,0 +1,23 @@
+#ifndef SUPERINSTRUCTION_TABLE_H_INCLUDED
+#define SUPERINSTRUCTION_TABLE_H_INCLUDED
+
+/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */
+
+#define SUPERINSTRUCTION_MAX_LENGTH 8
+
+static struct {
+    const char *name;
+    AVMOpcode   op;
+    int         length;
+    AVMOpcode   ops[SUPERINSTRUCTION_MAX_LENGTH];
+}
+SUPERINSTRUCTION_TABLE[] = {
+    {"AccInc", AVMOpcodeAccInc, 4, {AVMOpcodeAGet, AVMOpcode1, AVMOpcodeAdd, AVMOpcodeASet}},
+    {"Dup3Gt", AVMOpcodeDup3Gt, 3, {AVMOpcodeDup, AVMOpcode3, AVMOpcodeGt}},
+    {"DupUnder", AVMOpcodeDupUnder, 5, {AVMOpcode1, AVMOpcodeIndex, AVMOpcode3, AVMOpcode1, AVMOpcodeRoll}},
+    {"SwapIsEven", AVMOpcodeSwapIsEven, 4, {AVMOpcodeSwap, AVMOpcode1, AVMOpcodeAnd, AVMOpcodeEqZ}},
+    {"Over2Lte", AVMOpcodeOver2Lte, 3, {AVMOpcode2, AVMOpcodeIndex, AVMOpcodeLte}},
+    {NULL, 0, 0, {0}}
+};
+
+#endif // SUPERINSTRUCTION_TABLE_H_INCLUDED
@@ -0,0 +1,71 @@
+/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */
+
+/*
+ * Superinstructions run their opcodes in a row. Those marked +fast
+ * have a handler of their own that falls back to _chain_X.
+ */
+
+/* AGet 1 Add ASet */
+static AVMError _chain_AccInc(AVM vm)
+{
+    AVMError err;
+
+    if ((err = _parse_AGet(vm)) != AVM_NO_ERROR) return err;
+    if ((err = _parse_1(vm)) != AVM_NO_ERROR) return err;
+    if ((err = _parse_Add(vm)) != AVM_NO_ERROR) return err;
+
+    return _parse_ASet(vm);
+}
+
+/* Dup 3 Gt */
+static AVMError _chain_Dup3Gt(AVM vm)
+{
+    AVMError err;
+
+    if ((err = _parse_Dup(vm)) != AVM_NO_ERROR) return err;
+    if ((err = _parse_3(vm)) != AVM_NO_ERROR) return err;
+
+    return _parse_Gt(vm);
+}
+
+/* 1 Index 3 1 Roll */
+static AVMError _chain_DupUnder(AVM vm)
+{
+    AVMError err;
+
+    if ((err = _parse_1(vm)) != AVM_NO_ERROR) return err;
+    if ((err = _parse_Index(vm)) != AVM_NO_ERROR) return err;
+    if ((err = _parse_3(vm)) != AVM_NO_ERROR) return err;
+    if ((err = _parse_1(vm)) != AVM_NO_ERROR) return err;
+
+    return _parse_Roll(vm);
+}
+
+/* Swap 1 And EqZ */
+static AVMError _chain_SwapIsEven(AVM vm)
+{
+    AVMError err;
+
+    if ((err = _parse_Swap(vm)) != AVM_NO_ERROR) return err;
+    if ((err = _parse_1(vm)) != AVM_NO_ERROR) return err;
+    if ((err = _parse_And(vm)) != AVM_NO_ERROR) return err;
+
+    return _parse_EqZ(vm);
+}
+
+/* 2 Index Lte */
+static AVMError _chain_Over2Lte(AVM vm)
+{
+    AVMError err;
+
+    if ((err = _parse_2(vm)) != AVM_NO_ERROR) return err;
+    if ((err = _parse_Index(vm)) != AVM_NO_ERROR) return err;
+
+    return _parse_Lte(vm);
+}
+
+static AVMError _parse_Over2Lte(AVM vm)
+{
+    return _chain_Over2Lte(vm);
+}
+
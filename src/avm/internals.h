@@ -3,13 +3,109 @@
 
 #include "avm/avm.h"
 
+/*
+ * VALUES
+ *
+ * Stack slots are tagged 64 bit words. Integers, refs and marks are stored
+ * inline in the upper half; anything else is a pointer to a boxed object,
+ * with the low tag bits clear (objects are at least 8 byte aligned).
+ */
+
+    typedef uint64_t AVMValue;
+
+#   define AVM_VALUE_TAG_MASK    0x7
+#   define AVM_VALUE_TAG_OBJECT  0x0
+#   define AVM_VALUE_TAG_INTEGER 0x1
+#   define AVM_VALUE_TAG_REF     0x2
+#   define AVM_VALUE_TAG_MARK    0x3
+
+#   define AVM_VALUE_NULL        ((AVMValue)0)
+#   define AVM_VALUE_MARK        ((AVMValue)AVM_VALUE_TAG_MARK)
+
+#   define AVM_VALUE_TAG(V)        ((V) & AVM_VALUE_TAG_MASK)
+#   define AVM_VALUE_IS_OBJECT(V)  (AVM_VALUE_TAG(V) == AVM_VALUE_TAG_OBJECT)
+#   define AVM_VALUE_IS_INTEGER(V) (AVM_VALUE_TAG(V) == AVM_VALUE_TAG_INTEGER)
+#   define AVM_VALUE_IS_REF(V)     (AVM_VALUE_TAG(V) == AVM_VALUE_TAG_REF)
+#   define AVM_VALUE_IS_MARK(V)    (AVM_VALUE_TAG(V) == AVM_VALUE_TAG_MARK)
+
+#   define AVM_VALUE_INTEGER(V)    ((int32_t)(uint32_t)((V) >> 32))
+#   define AVM_VALUE_REF(V)        ((uint32_t)((V) >> 32))
+#   define AVM_VALUE_OBJECT(V)     ((AVMObject)(uintptr_t)(V))
+
+#   define AVM_VALUE_FROM_INTEGER(I) \
+        (((AVMValue)(uint32_t)(I) << 32) | AVM_VALUE_TAG_INTEGER)
+#   define AVM_VALUE_FROM_REF(R) \
+        (((AVMValue)(uint32_t)(R) << 32) | AVM_VALUE_TAG_REF)
+#   define AVM_VALUE_FROM_OBJECT(O) \
+        ((AVMValue)(uintptr_t)(O))
+
+/* native code, loaded or compiled, is entered from threaded dispatch */
+#if defined(__GNUC__) && (defined(__unix__) || defined(__APPLE__)) \
+ && !defined(AVM_NO_THREADED_DISPATCH) && !defined(AVM_NO_NATIVE)
+#   define AVM_NATIVE
+#endif
+
+/* the JIT emits x86-64 */
+#if defined(AVM_NATIVE) && defined(__x86_64__) && defined(__linux__) \
+ && !defined(AVM_NO_JIT)
+#   define AVM_JIT
+#endif
+
+/* byte kernels use SSE2, and AVX2 where the CPU has it */
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(AVM_NO_SIMD)
+#   define AVM_SIMD
+#endif
+
 #define ALLOC_OPAQUE_STRUCT(TYPE) ALLOC_OPAQUE_STRUCT_WITH_EXTRA(TYPE,0)
 #define ALLOC_OPAQUE_STRUCT_WITH_EXTRA(TYPE,EXTRA) ((TYPE)malloc((EXTRA)+sizeof(struct _##TYPE)))
 /*
  * VM
  */
 
-    typedef struct _AVMPool* AVMPool;
+    typedef struct _AVMPool*    AVMPool;
+    typedef struct _AVMProfile* AVMProfile;
+
+    /*
+     * Execution frames. Calls and code blocks run on an explicit frame
+     * stack rather than on the C stack; vm->runtime.code/pos/size cache
+     * the state of the topmost frame.
+     */
+    typedef enum
+    {
+        AVMFrameRun,    /* program passed to avm_run */
+        AVMFrameBlock,  /* if / ifelse body */
+        AVMFrameCall,   /* $name */
+        AVMFrameRepeat,
+        AVMFrameFor
+    } AVMFrameKind;
+
+    struct _AVMFrame
+    {
+        AVMCode   code;  /* owned by the frame */
+        size_t    pos,   /* saved while a callee runs */
+                  start, /* inline loops run a slice of code */
+                  end;
+        uint8_t   kind,
+                  window; /* owns a window: not inline loops, unless replacing a block */
+        int32_t   count,  /* repeat: iterations left, for: current value */
+                  limit,
+                  step;
+        /* caller's state: its window, and for runs and calls registers */
+        uint32_t  locals, /* first local */
+                  saved;  /* where its saved registers end */
+        uint16_t  regs;   /* registers it had set */
+    };
+
+#   define AVM_FRAMES_INITIAL_RESERVE 16
+#   define AVM_FRAMES_MAX             (1<<20)
+
+#   define AVM_LOCALS_INITIAL_RESERVE 16
+
+    struct _AVMSavedReg
+    {
+        AVMValue value;
+        uint8_t  reg;
+    };
 
     struct _AVM
     {
@@ -29,23 +125,86 @@
             const char *code;
             size_t      pos,
                         size;
+            AVMCode     root; /* owns the bytes of code */
+            uint8_t     verified;
             AVMStack    stack;
+
+            struct _AVMFrame *frames;
+            uint32_t    depth,
+                        reserved,
+                        base; /* depth at entry of the innermost avm_run */
+
             AVMDict     vars;
-            AVMObject   acc;
+
+            /*
+             * A call starts with no register set. The caller's value of a
+             * register is saved when the callee first sets it, and put
+             * back when the call (or the avm_run) returns.
+             */
+            AVMValue    regs[AVM_REGISTERS];
+            uint16_t    regs_set; /* by the running call */
+            struct
+            {
+                struct _AVMSavedReg *ptr;
+                uint32_t used,
+                         reserved;
+            } saved;
+
+            /*
+             * Local slots of the running blocks, one window each on top
+             * of the other. Inline loops use the window they run in.
+             */
+            struct
+            {
+                AVMValue *slots;
+                uint32_t  base, /* first slot of the innermost window */
+                          used,
+                          reserved;
+            } locals;
         } runtime;
         
-        AVMPool integer_pool;
+        AVMPool pool;
+
+        /* last program run by avm_run, kept with what was decoded of it */
+        AVMCode program;
+
+        /* last program run by avm_run_verified */
+        struct
+        {
+            AVMCode  code;
+            uint32_t need; /* stack entries it provably consumes */
+        } verified;
 
         /* stats */
         uint32_t icount; /* instruction count */
+        uint32_t cache_hits,
+                 cache_misses;
+
+        AVMProfile profile; /* n-gram counts, while avm_profile is on */
+
+        struct
+        {
+            uint32_t threshold, /* block starts before compiling, 0 when off */
+                     flags;
+            uint32_t blocks,    /* stats */
+                     bytes,
+                     natives;
+        } jit;
+
+        struct _AVMNativeLib *natives; /* avm_load_native, latest first */
     };
     
 #   define AVM_DEFAULT_HASH_SEED 0x873d1ae5
 
+    void _avm_profile_op   (AVMProfile, uint8_t op);
+    void _avm_profile_break(AVMProfile);
+    void _avm_profile_free (AVMProfile);
+
     AVMHash _avm_default_hash(const char *, size_t, AVMHash);
     /*AVMHash _avm_hash        (AVM, const char*, size_t);*/
     void    _avm_set_error   (AVM, uint16_t, size_t);
-    AVMInteger _avm_create_integer(int32_t);
+
+#   define AVM_VM_POOL(VM) ((VM)? (VM)->pool : NULL)
 
 /*
  * OBJECTS
@@ -67,12 +226,99 @@
         int32_t  value;
     };
 
+    /*
+     * Strings and code are immutable once shared; copies only take a ref.
+     * A view borrows its bytes from parent, which it keeps alive. Bytes
+     * are the same, but written to in place while nobody else holds them.
+     *
+     * Past fill, the storage of a root is free: whatever ends at fill can
+     * be appended to there, shared or not, since nobody sees those bytes.
+     */
+#define AVM_VIEW_PIN_RATIO 4 /* a lone view this much smaller is copied out */
+
     struct _AVMString
     {
-        uint8_t  type;
-        uint32_t length;
-        char     data[];
+        uint8_t   type;
+        uint8_t   flags;
+        uint32_t  refs;
+        uint32_t  length;
+        uint32_t  fill;    /* bytes of storage in use, roots only */
+        char     *data;
+        AVMString parent;
+        struct _AVMDecoded *decoded; /* once run, kept by the root */
+        char      storage[];
+    };
+
+    /*
+     * An instruction decoded on its first run, kept at the position of its
+     * opcode. The operand is sign extended for integers and the length of
+     * what follows for strings, code and loops; length counts the bytes
+     * after the opcode, data included, for checking it against a frame.
+     */
+    typedef struct _AVMInsn
+    {
+        const void *handler;
+        uint32_t    operand;
+        uint32_t    length;
+    } AVMInsn;
+
+    /* a $name site: the entry it found, while the dict keeps its shape */
+    typedef struct
+    {
+        AVMHash               hash;
+        uint32_t              generation;
+        AVMDict               dict;
+        struct _AVMDictEntry *entry;
+    } AVMRefCache;
+
+    /* what a program decoded of itself, indexed like its code */
+    struct _AVMDecoded
+    {
+        AVMRefCache *caches;
+        uint32_t     ncaches,
+                     reserved;
+        struct _AVMJitCode *jit; /* once a block of it got hot */
+        AVMInsn      insns[];
+    };
+
+    void _avm_decoded_free(struct _AVMDecoded*);
+
+    /*
+     * JIT. Blocks are compiled once they have started often enough, and
+     * entered at the decoded instructions of their start and of the points
+     * where compiled code hands control opcodes back to the interpreter.
+     * Positions are offsets in the root; delta is where the running frame's
+     * code starts in it.
+     */
+    typedef AVMError (* AVMParser)(AVM);
+    typedef AVMError (* AVMJitFn) (AVM, size_t delta, const void *at);
+
+    struct _AVMJitEntry
+    {
+        AVMJitFn    fn;
+        const void *at;
+        size_t      end; /* of its block */
     };
+
+    struct _AVMJitCode
+    {
+        uint16_t            *heat; /* starts of the block at each position */
+        struct _AVMJitEntry *entries;
+        uint32_t             nentries,
+                             reserved;
+        struct _AVMJitBlock *blocks; /* executable memory */
+    };
+
+    void _avm_jit_heat(AVM, AVMCode root, size_t start, size_t end,
+                       const AVMParser *parsers, const void *enter);
+    char _avm_jit_entry(struct _AVMJitCode*, AVMJitFn, const void *at, size_t end);
+    void _avm_jit_free(struct _AVMJitCode*);
+
+    /* blocks of loaded modules are entered like compiled ones */
+    char _avm_native_block(AVM, AVMCode root, size_t start, size_t end,
+                           const void *enter);
+    int  _avm_native_again(AVM, size_t start);
+    void _avm_native_free (struct _AVMNativeLib*);
     
     struct _AVMRef
     {
@@ -86,8 +332,91 @@
         AVMExternalType ptr;
     };
     
+#   define AVM_CODE_VERIFIED 0x01 /* passed avm_verify */
+
     size_t _avm_object_raw_size(AVMObject);
 
+    /* same as the public constructors, allocating from the VM pool */
+    AVMString _avm_create_string(AVM, const char*, uint32_t);
+    AVMCode   _avm_create_code  (AVM, const char*, uint32_t);
+    AVMBytes  _avm_create_bytes (AVM, const char*, uint32_t);
+    AVMString _avm_create_view  (AVM, AVMType, AVMString parent, const char*, uint32_t);
+    AVMObject _avm_object_copy  (AVM, AVMObject);
+
+    /* private writable string, or NULL when out of memory (s is released) */
+    AVMString _avm_string_unshare(AVM, AVMString s);
+    AVMString _avm_string_append (AVM, AVMString s, const char*, uint32_t);
+
+    /* s as a string or bytes: the same object when nobody else holds it */
+    AVMString _avm_string_retype(AVM, AVMString s, AVMType t);
+
+    /* n bytes of s from at, sharing them where it pays (s is released) */
+    AVMString _avm_string_trim(AVM, AVMString s, uint32_t at, uint32_t n);
+
+    /* boxing adapters between stack values and public objects */
+    AVMObject _avm_value_box        (AVM, AVMValue);
+    AVMValue  _avm_value_unbox      (AVM, AVMObject);
+    AVMValue  _avm_value_copy_object(AVM, AVMObject);
+
+    static inline AVMType _avm_value_type(AVMValue v)
+    {
+        switch (AVM_VALUE_TAG(v))
+        {
+            case AVM_VALUE_TAG_INTEGER: return AVMTypeInteger;
+            case AVM_VALUE_TAG_REF:     return AVMTypeRef;
+            case AVM_VALUE_TAG_MARK:    return AVMTypeMark;
+            default:
+                return v? (AVMType)AVM_VALUE_OBJECT(v)->type : AVMTypeObject;
+        }
+    }
+
+    static inline int _avm_value_is(AVMValue v, AVMType t)
+    {
+        return AVM_VALUE_IS_OBJECT(v) && v && AVM_VALUE_OBJECT(v)->type == t;
+    }
+
+    static inline void _avm_value_free(AVM vm, AVMValue v)
+    {
+        if (AVM_VALUE_IS_OBJECT(v) && v)
+            avm_object_free(vm, AVM_VALUE_OBJECT(v));
+    }
+
+    /* returns AVM_VALUE_NULL when out of memory */
+    static inline AVMValue _avm_value_copy(AVM vm, AVMValue v)
+    {
+        if (AVM_VALUE_IS_OBJECT(v) && v)
+            return AVM_VALUE_FROM_OBJECT(_avm_object_copy(vm,AVM_VALUE_OBJECT(v)));
+        return v;
+    }
+
+/*
+ * VERIFIER
+ */
+
+    typedef enum
+    {
+        AVMOperandNone,
+        AVMOperandValue,   /* hash */
+        AVMOperandInteger, /* signed */
+        AVMOperandBlob,    /* length, then that many bytes of string */
+        AVMOperandCode,    /* length, then a nested code block */
+        AVMOperandJump,    /* signed offset from the end of the instruction */
+        AVMOperandLoop,    /* length, then an inline loop body */
+        AVMOperandSlot     /* index of a local or a register */
+    } AVMOperandKind;
+
+    typedef struct
+    {
+        uint8_t valid;
+        int8_t  pops,   /* -1 when it depends on the values involved */
+                pushes; /* lower bound */
+        uint8_t operand_bytes;
+        uint8_t operand;
+        uint8_t control; /* may switch frames */
+    } AVMOpcodeInfo;
+
+    AVMError _avm_verify(AVM, const char*, size_t, uint32_t *need);
+
 /*
  * STACK
  */
@@ -98,46 +427,159 @@
     {
         uint32_t  used,
                   reserved;
-        AVMObject *ptr;
+        uint32_t  boxed; /* lowest slot boxed in place by avm_stack_at */
+        AVMValue *ptr;
+
+        /*
+         * Slots of the marks, from the bottom, for counttomark: pushes add
+         * them, and pops leave them behind until they're found stale. Marks
+         * moved or copied elsewhere are looked for from unindexed up.
+         */
+        uint32_t *marks;
+        uint32_t  nmarks,
+                  rmarks;
+        uint32_t  unindexed;
     };
-    
-    void _avm_stack_set(AVMStack s, uint32_t n, AVMObject o);
+
+#   define AVM_STACK_NOT_BOXED UINT32_MAX
+#   define AVM_STACK_INDEXED   UINT32_MAX
+
+    char     _avm_stack_grow (AVMStack s);
+    void     _avm_stack_unbox(AVMStack s);
+    AVMError _avm_stack_push_mark    (AVMStack s, AVMValue v);
+    AVMError _avm_stack_count_to_mark(AVMStack s, uint32_t *n);
+
+    /* on the top n values, in place */
+    char     _avm_stack_reserve(AVMStack s, uint32_t n); /* room for n more */
+    void     _avm_stack_reverse(AVMStack s, uint32_t n);
+    void     _avm_stack_rotate (AVMStack s, uint32_t n, uint32_t d);
+    AVMError _avm_stack_copy   (AVM vm, AVMStack s, uint32_t n);
+
+    /* kernels.c */
+    void _avm_explode(AVMValue *to, const uint8_t *from, uint32_t n);
+    int  _avm_implode(uint8_t *to, const AVMValue *from, uint32_t n);
+
+    /* codecs: the decoders return 0 on input they don't take */
+    void     _avm_base64_encode(char *to, const uint8_t *from, uint32_t n);
+    int      _avm_base64_decode(uint8_t *to, const char *from, uint32_t n,
+                                uint32_t *length);
+    void     _avm_hex_encode   (char *to, const uint8_t *from, uint32_t n);
+    int      _avm_hex_decode   (uint8_t *to, const char *from, uint32_t n);
+    uint32_t _avm_crc32c       (uint32_t crc, const uint8_t *from, uint32_t n);
+
+    int64_t _avm_find(const uint8_t *h, uint32_t n, const uint8_t *needle, uint32_t m);
+
+    static inline AVMValue _avm_stack_value_at(AVMStack s, uint32_t pos)
+    {
+        return (pos < s->used)? s->ptr[s->used - 1 - pos] : AVM_VALUE_NULL;
+    }
+
+    /* marks put in the top n slots other than by a push */
+    static inline void _avm_stack_moved(AVMStack s, uint32_t n)
+    {
+        if (s->used - n < s->unindexed)
+            s->unindexed = s->used - n;
+    }
+
+    static inline void _avm_stack_set_value(AVMStack s, uint32_t n, AVMValue v)
+    {
+        if (n < s->used)
+        {
+            s->ptr[s->used - 1 - n] = v;
+
+            if (AVM_VALUE_IS_MARK(v))
+                _avm_stack_moved(s, n + 1);
+        }
+    }
+
+    static inline AVMError _avm_stack_push_value(AVMStack s, AVMValue v)
+    {
+        if (AVM_VALUE_IS_MARK(v))
+            return _avm_stack_push_mark(s, v);
+
+        if (s->used == s->reserved && !_avm_stack_grow(s))
+            return AVM_ERROR_NO_MEM;
+
+        s->ptr[s->used++] = v;
+        return AVM_NO_ERROR;
+    }
+
+    static inline AVMValue _avm_stack_pop_value(AVMStack s)
+    {
+        return s->used? s->ptr[ -- s->used] : AVM_VALUE_NULL;
+    }
+
+    /* host code may have boxed immediates in place; undo it */
+    static inline void _avm_stack_canonicalize(AVMStack s)
+    {
+        if (s->boxed != AVM_STACK_NOT_BOXED)
+            _avm_stack_unbox(s);
+    }
 
 /*
  * DICT
  */
-#define AVM_DICT_MIN_SIZE_EXP     4
-#define AVM_DICT_DEFAULT_SIZE_EXP 10
-#define AVM_DICT_MAX_SIZE_EXP     16
+#define AVM_DICT_MIN_SIZE_EXP     4  /* one group */
+#define AVM_DICT_DEFAULT_SIZE_EXP 6
+#define AVM_DICT_MAX_SIZE_EXP     16 /* initial size only, it grows past it */
+#define AVM_DICT_GROUP            16 /* control bytes probed at once */
     
     struct _AVMDictEntry
     {
         AVMHash   key;
         AVMObject value;
-        struct _AVMDictEntry *next;
     };
 
     struct _AVMDict
     {
         uint32_t     size,
-                     mask;
-                     //count;
-        struct _AVMDictEntry* dict[];
+                     mask,
+                     count,
+                     tombstones,
+                     generation; /* bumped when entries come, go or move */
+        uint8_t     *ctrl;       /* size + AVM_DICT_GROUP control bytes */
+        struct _AVMDictEntry *entries;
     };
 
+    /* same as the public functions, releasing values to the VM pool */
+    AVMError _avm_dict_set   (AVM, AVMDict, AVMHash, AVMObject);
+    AVMError _avm_dict_remove(AVM, AVMDict, AVMHash);
+    void     _avm_dict_free  (AVM, AVMDict);
+
+    struct _AVMDictEntry* _avm_dict_entry(AVMDict, AVMHash);
+
     /*
      * Memory Pool
      */
 
+#define AVM_POOL_MIN_BLOCK_EXP     4  /* 16 bytes */
+#define AVM_POOL_MAX_BLOCK_EXP     16 /* 64 KiB */
+#define AVM_POOL_MAX_CLASSES       (AVM_POOL_MAX_BLOCK_EXP-AVM_POOL_MIN_BLOCK_EXP+1)
+#define AVM_POOL_DEFAULT_MAX_BLOCK 256
+
+#define AVM_POOL_CLASS_SIZE(C)     ((size_t)1 << ((C)+AVM_POOL_MIN_BLOCK_EXP))
+
+    struct _AVMPoolClass
+    {
+        void     *head; /* free list, linked through the blocks */
+        uint32_t  cached,
+                  max;
+        uint32_t  hits,
+                  misses;
+    };
+
     struct _AVMPool
     {
-        uint32_t max, used;
-        struct _AVMObject *v[];
+        uint32_t max_size;
+        uint32_t nclasses;
+        struct _AVMPoolClass c[AVM_POOL_MAX_CLASSES];
     };
     
-    AVMInteger avm_pool_get_integer(AVMPool c, uint32_t value);
-    void       avm_pool_release(AVMPool c, AVMObject o);
-    AVMPool    avm_pool_init(uint32_t size);
+    void*      avm_pool_alloc(AVMPool c, size_t size);
+    void*      avm_pool_grow(void *ptr, size_t size, size_t new_size);
+    size_t     avm_pool_block_size(size_t size);
+    void       avm_pool_release(AVMPool c, void *ptr, size_t size);
+    AVMPool    avm_pool_init(uint32_t blocks, uint32_t max_size);
     void       avm_pool_free(AVMPool c);
 
 #endif /* AVM_INTERNALS_INCLUDED */
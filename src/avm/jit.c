@@ -0,0 +1,953 @@
+#include "avm/internals.h"
+
+#include "avm/generated/opcodes.h"
+#include "avm/generated/opcode-info.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Baseline JIT for x86-64. A block is compiled in one pass, each
+ * instruction from a template: integer constants, arithmetic, comparisons,
+ * stack shuffles and jumps get a fast path for immediate values, and fall
+ * back to a call of their parser otherwise. Every other opcode is just
+ * that call. Control opcodes leave compiled code with vm->runtime.pos at
+ * them, for the interpreter to run; the instruction after one is an entry.
+ *
+ * Compiled code keeps vm in rbx, the stack in r12 and delta in r13, and
+ * counts instructions straight into vm->icount.
+ */
+
+#ifdef AVM_JIT
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+struct _AVMJitBlock
+{
+    struct _AVMJitBlock *next;
+    void                *code;
+    size_t               size;
+};
+
+enum { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+       R8, R9, R10, R11, R12, R13, R14, R15 };
+
+enum { CC_B = 0x2, CC_AE = 0x3, CC_E  = 0x4, CC_NE = 0x5,
+       CC_L = 0xc, CC_GE = 0xd, CC_LE = 0xe, CC_G  = 0xf };
+
+#define VM_POS    offsetof(struct _AVM, runtime.pos)
+#define VM_STACK  offsetof(struct _AVM, runtime.stack)
+#define VM_ICOUNT offsetof(struct _AVM, icount)
+
+#define S_USED     offsetof(struct _AVMStack, used)
+#define S_RESERVED offsetof(struct _AVMStack, reserved)
+#define S_PTR      offsetof(struct _AVMStack, ptr)
+
+#define NO_LABEL ((size_t)-1)
+
+/* longest run of forward jumps a template makes to its slow path */
+#define MAX_SLOW_JUMPS 4
+
+#define MIN_BLOCK_INSNS 4
+
+typedef struct
+{
+    uint8_t *buf;
+    size_t   used,
+             reserved;
+    char     failed;
+
+    size_t   epilogue;
+} Emitter;
+
+/*
+ * ASSEMBLER
+ */
+
+static void _byte(Emitter *e, uint8_t b)
+{
+    if (e->used == e->reserved)
+    {
+        size_t   reserved = e->reserved? e->reserved * 2 : 4096;
+        uint8_t *buf      = realloc(e->buf, reserved);
+
+        if (buf == NULL)
+        {
+            e->failed = 1;
+            return;
+        }
+
+        e->buf      = buf;
+        e->reserved = reserved;
+    }
+
+    e->buf[e->used++] = b;
+}
+
+static void _u32(Emitter *e, uint32_t v)
+{
+    int i;
+    for (i=0;i<4;++i)
+        _byte(e, (uint8_t)(v >> 8*i));
+}
+
+static void _u64(Emitter *e, uint64_t v)
+{
+    _u32(e, (uint32_t)v);
+    _u32(e, (uint32_t)(v >> 32));
+}
+
+static void _rex(Emitter *e, int w, int reg, int index, int base)
+{
+    uint8_t rex = 0x40 | (w? 8 : 0) | ((reg & 8)? 4 : 0)
+                | ((index & 8)? 2 : 0) | ((base & 8)? 1 : 0);
+
+    if (rex != 0x40)
+        _byte(e, rex);
+}
+
+static void _disp(Emitter *e, int mod, int32_t disp)
+{
+    if (mod == 1)
+        _byte(e, (uint8_t)disp);
+    else if (mod == 2)
+        _u32(e, (uint32_t)disp);
+}
+
+static int _mod(int base, int32_t disp)
+{
+    if (disp == 0 && (base & 7) != RBP)
+        return 0;
+
+    return disp >= -128 && disp <= 127? 1 : 2;
+}
+
+/* op reg, [base + disp] */
+static void _op_mem(Emitter *e, int w, uint8_t op, int reg, int base, int32_t disp)
+{
+    int mod = _mod(base, disp);
+
+    _rex(e, w, reg, 0, base);
+    _byte(e, op);
+    _byte(e, (mod << 6) | ((reg & 7) << 3) | (base & 7));
+
+    if ((base & 7) == RSP)
+        _byte(e, 0x24);
+
+    _disp(e, mod, disp);
+}
+
+/* op reg, [base + index*8 + disp] */
+static void _op_slot(Emitter *e, int w, uint8_t op, int reg, int base, int index, int32_t disp)
+{
+    int mod = _mod(base, disp);
+
+    _rex(e, w, reg, index, base);
+    _byte(e, op);
+    _byte(e, (mod << 6) | ((reg & 7) << 3) | 4);
+    _byte(e, (3 << 6) | ((index & 7) << 3) | (base & 7));
+    _disp(e, mod, disp);
+}
+
+/* op rm, reg */
+static void _op_reg(Emitter *e, int w, uint8_t op, int reg, int rm)
+{
+    _rex(e, w, reg, 0, rm);
+    _byte(e, op);
+    _byte(e, 0xc0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+/* op rm, imm8 for the 0x83 and 0xc1 groups */
+static void _op_imm8(Emitter *e, int w, uint8_t op, int ext, int rm, int8_t imm)
+{
+    _op_reg(e, w, op, ext, rm);
+    _byte(e, (uint8_t)imm);
+}
+
+static void _mov_imm64(Emitter *e, int reg, uint64_t imm)
+{
+    _rex(e, 1, 0, 0, reg);
+    _byte(e, 0xb8 + (reg & 7));
+    _u64(e, imm);
+}
+
+static void _setcc(Emitter *e, int cc, int reg)
+{
+    _byte(e, 0x0f);
+    _byte(e, 0x90 + cc);
+    _byte(e, 0xc0 | reg);
+}
+
+static void _movzx8(Emitter *e, int dst, int src)
+{
+    _byte(e, 0x0f);
+    _byte(e, 0xb6);
+    _byte(e, 0xc0 | (dst << 3) | src);
+}
+
+/* jumps with a rel32 to patch, returning where it is */
+static size_t _jcc(Emitter *e, int cc)
+{
+    _byte(e, 0x0f);
+    _byte(e, 0x80 + cc);
+    _u32(e, 0);
+    return e->used - 4;
+}
+
+static size_t _jmp(Emitter *e)
+{
+    _byte(e, 0xe9);
+    _u32(e, 0);
+    return e->used - 4;
+}
+
+static void _patch(Emitter *e, size_t rel, size_t target)
+{
+    if (e->failed)
+        return;
+
+    uint32_t v = (uint32_t)(target - (rel + 4));
+    memcpy(&e->buf[rel], &v, 4);
+}
+
+static void _jcc_to(Emitter *e, int cc, size_t target)
+{
+    _patch(e, _jcc(e, cc), target);
+}
+
+static void _jmp_to(Emitter *e, size_t target)
+{
+    _patch(e, _jmp(e), target);
+}
+
+/*
+ * TEMPLATES
+ */
+
+/* vm->runtime.pos = pos - delta */
+static void _set_pos(Emitter *e, size_t pos)
+{
+    _mov_imm64(e, RAX, pos);
+    _op_reg(e, 1, 0x29, R13, RAX);            /* sub rax, r13 */
+    _op_mem(e, 1, 0x89, RAX, RBX, VM_POS);    /* mov [rbx+pos], rax */
+}
+
+static void _count(Emitter *e)
+{
+    _op_mem(e, 0, 0x83, 0, RBX, VM_ICOUNT);   /* add dword [rbx+icount], 1 */
+    _byte(e, 1);
+}
+
+/* leaves compiled code at pos, for the interpreter to go on */
+static void _exit_at(Emitter *e, size_t pos)
+{
+    _set_pos(e, pos);
+    _op_reg(e, 0, 0x31, RAX, RAX);            /* xor eax, eax */
+    _jmp_to(e, e->epilogue);
+}
+
+/* runs the opcode at pos through its parser, leaving on errors */
+static void _call_parser(Emitter *e, AVMParser parser, size_t pos)
+{
+    _set_pos(e, pos + 1);
+    _op_reg(e, 1, 0x89, RBX, RDI);            /* mov rdi, rbx */
+    _mov_imm64(e, RAX, (uint64_t)(uintptr_t)parser);
+    _byte(e, 0xff);                           /* call rax */
+    _byte(e, 0xd0);
+    _op_reg(e, 0, 0x85, RAX, RAX);            /* test eax, eax */
+    _jcc_to(e, CC_NE, e->epilogue);
+}
+
+/* eax = used, jumping to the slow path unless used >= n */
+static void _need(Emitter *e, int n, size_t *slow, int *nslow)
+{
+    _op_mem(e, 0, 0x8b, RAX, R12, S_USED);    /* mov eax, [r12+used] */
+    _op_imm8(e, 0, 0x83, 7, RAX, n);          /* cmp eax, n */
+    slow[(*nslow)++] = _jcc(e, CC_B);
+}
+
+/* eax < reserved, or the slow path */
+static void _room(Emitter *e, size_t *slow, int *nslow)
+{
+    _op_mem(e, 0, 0x3b, RAX, R12, S_RESERVED);
+    slow[(*nslow)++] = _jcc(e, CC_AE);
+}
+
+/* reg = the value n below the top, rcx being the stack's slots */
+static void _load(Emitter *e, int reg, int n)
+{
+    _op_slot(e, 1, 0x8b, reg, RCX, RAX, -8*(n+1));
+}
+
+static void _store(Emitter *e, int reg, int n)
+{
+    _op_slot(e, 1, 0x89, reg, RCX, RAX, -8*(n+1));
+}
+
+/* the slow path unless reg holds an integer; clobbers edi */
+static void _is_integer(Emitter *e, int reg, size_t *slow, int *nslow)
+{
+    _op_reg(e, 0, 0x89, reg, RDI);                         /* mov edi, reg */
+    _op_imm8(e, 0, 0x83, 4, RDI, AVM_VALUE_TAG_MASK);      /* and edi, 7 */
+    _op_imm8(e, 0, 0x83, 7, RDI, AVM_VALUE_TAG_INTEGER);   /* cmp edi, 1 */
+    slow[(*nslow)++] = _jcc(e, CC_NE);
+}
+
+/* the slow path when reg holds an object, as copies and pops own those */
+static void _is_immediate(Emitter *e, int reg, size_t *slow, int *nslow)
+{
+    _op_reg(e, 0, 0xf7, 0, reg);                           /* test reg, 7 */
+    _u32(e, AVM_VALUE_TAG_MASK);
+    slow[(*nslow)++] = _jcc(e, CC_E);
+}
+
+/* the slow path when reg holds a mark, for the stack to index it moved */
+static void _not_mark(Emitter *e, int reg, size_t *slow, int *nslow)
+{
+    _op_reg(e, 0, 0x89, reg, RDI);                         /* mov edi, reg */
+    _op_imm8(e, 0, 0x83, 4, RDI, AVM_VALUE_TAG_MASK);      /* and edi, 7 */
+    _op_imm8(e, 0, 0x83, 7, RDI, AVM_VALUE_TAG_MARK);      /* cmp edi, 3 */
+    slow[(*nslow)++] = _jcc(e, CC_E);
+}
+
+/* the integer in the upper half of reg, tagged back */
+static void _tag_integer(Emitter *e, int reg)
+{
+    _op_imm8(e, 1, 0xc1, 4, reg, 32);                      /* shl reg, 32 */
+    _op_imm8(e, 1, 0x83, 1, reg, AVM_VALUE_TAG_INTEGER);   /* or reg, 1 */
+}
+
+static void _set_used(Emitter *e, int delta)
+{
+    _op_imm8(e, 0, 0x83, delta > 0? 0 : 5, RAX, delta > 0? delta : -delta);
+    _op_mem(e, 0, 0x89, RAX, R12, S_USED);
+}
+
+static void _push_constant(Emitter *e, AVMValue v, size_t *slow, int *nslow)
+{
+    _op_mem(e, 0, 0x8b, RAX, R12, S_USED);
+    _room(e, slow, nslow);
+    _op_mem(e, 1, 0x8b, RCX, R12, S_PTR);
+    _mov_imm64(e, RDX, v);
+    _store(e, RDX, -1);
+    _set_used(e, 1);
+}
+
+/* a op b for two integers, with the flags of a comparison against 0 */
+static void _binary(Emitter *e, AVMOpcode op, size_t *slow, int *nslow)
+{
+    _need(e, 2, slow, nslow);
+    _op_mem(e, 1, 0x8b, RCX, R12, S_PTR);
+    _load(e, RDX, 0);
+    _load(e, RSI, 1);
+    _is_integer(e, RDX, slow, nslow);
+    _is_integer(e, RSI, slow, nslow);
+    _op_imm8(e, 1, 0xc1, 5, RDX, 32);         /* shr rdx, 32 */
+    _op_imm8(e, 1, 0xc1, 5, RSI, 32);
+
+    switch (op)
+    {
+        case AVMOpcodeAdd: _op_reg(e, 0, 0x01, RDX, RSI); break;
+        case AVMOpcodeSub: _op_reg(e, 0, 0x29, RDX, RSI); break;
+        case AVMOpcodeAnd: _op_reg(e, 0, 0x21, RDX, RSI); break;
+        case AVMOpcodeOr:  _op_reg(e, 0, 0x09, RDX, RSI); break;
+
+        case AVMOpcodeMul:                    /* imul esi, edx */
+            _byte(e, 0x0f);
+            _byte(e, 0xaf);
+            _byte(e, 0xc0 | (RSI << 3) | RDX);
+            break;
+
+        default:
+        {
+            /* as _compare: the sign of a - b, wrapping around */
+            int cc = op == AVMOpcodeEq ? CC_E
+                   : op == AVMOpcodeNeq? CC_NE
+                   : op == AVMOpcodeLt ? CC_L
+                   : op == AVMOpcodeLte? CC_LE
+                   : op == AVMOpcodeGt ? CC_G
+                   :                     CC_GE;
+
+            _op_reg(e, 0, 0x29, RDX, RSI);    /* sub esi, edx */
+            _op_reg(e, 0, 0x85, RSI, RSI);    /* test esi, esi */
+            _setcc(e, cc, RDX);
+            _movzx8(e, RSI, RDX);
+        }
+        break;
+    }
+
+    _tag_integer(e, RSI);
+    _store(e, RSI, 1);
+    _set_used(e, -1);
+}
+
+static void _unary(Emitter *e, AVMOpcode op, size_t *slow, int *nslow)
+{
+    _need(e, 1, slow, nslow);
+    _op_mem(e, 1, 0x8b, RCX, R12, S_PTR);
+    _load(e, RDX, 0);
+    _is_integer(e, RDX, slow, nslow);
+
+    switch (op)
+    {
+        case AVMOpcodeInc:
+        case AVMOpcodeDec:
+            /* in the upper half, where it wraps around by itself */
+            _mov_imm64(e, RSI, (uint64_t)1 << 32);
+            _op_reg(e, 1, op == AVMOpcodeInc? 0x01 : 0x29, RSI, RDX);
+            break;
+
+        default:
+            _op_imm8(e, 1, 0xc1, 5, RDX, 32);
+            _op_reg(e, 0, 0x85, RDX, RDX);    /* test edx, edx */
+            _setcc(e, op == AVMOpcodeNeqZ? CC_NE : CC_E, RDX);
+            _movzx8(e, RDX, RDX);
+            _tag_integer(e, RDX);
+            break;
+    }
+
+    _store(e, RDX, 0);
+}
+
+/* the fast path of op, or 0 when it has none */
+static int _fast(Emitter *e, AVMOpcode op, const uint8_t *code, size_t pos,
+                 size_t *slow, int *nslow)
+{
+    const AVMOpcodeInfo *info = &OPCODE_INFO[op];
+
+    if (op >= AVMOpcode0 && op <= AVMOpcode7)
+    {
+        _push_constant(e, AVM_VALUE_FROM_INTEGER(op - AVMOpcode0), slow, nslow);
+        return 1;
+    }
+
+    if (op >= AVMOpcodeN1 && op <= AVMOpcodeN7)
+    {
+        _push_constant(e, AVM_VALUE_FROM_INTEGER(AVMOpcodeN1 - op - 1), slow, nslow);
+        return 1;
+    }
+
+    switch (op)
+    {
+        case AVMOpcodeInt8:
+        case AVMOpcodeInt16:
+        case AVMOpcodeInt24:
+        case AVMOpcodeInt32:
+        {
+            int32_t  bits  = 8 * info->operand_bytes;
+            uint32_t value = 0;
+            int      i;
+
+            for (i=0;i<info->operand_bytes;++i)
+                value = (value << 8) | code[pos+1+i];
+
+            if (bits < 32)
+                value = (uint32_t)((int32_t)(value << (32-bits)) >> (32-bits));
+
+            _push_constant(e, AVM_VALUE_FROM_INTEGER(value), slow, nslow);
+            return 1;
+        }
+
+        case AVMOpcodeAdd:
+        case AVMOpcodeSub:
+        case AVMOpcodeMul:
+        case AVMOpcodeAnd:
+        case AVMOpcodeOr:
+        case AVMOpcodeEq:
+        case AVMOpcodeNeq:
+        case AVMOpcodeLt:
+        case AVMOpcodeLte:
+        case AVMOpcodeGt:
+        case AVMOpcodeGte:
+            _binary(e, op, slow, nslow);
+            return 1;
+
+        case AVMOpcodeInc:
+        case AVMOpcodeDec:
+        case AVMOpcodeEqZ:
+        case AVMOpcodeNeqZ:
+        case AVMOpcodeNot:
+            _unary(e, op, slow, nslow);
+            return 1;
+
+        case AVMOpcodeDup:
+            _need(e, 1, slow, nslow);
+            _room(e, slow, nslow);
+            _op_mem(e, 1, 0x8b, RCX, R12, S_PTR);
+            _load(e, RDX, 0);
+            _is_immediate(e, RDX, slow, nslow);
+            _not_mark(e, RDX, slow, nslow);
+            _store(e, RDX, -1);
+            _set_used(e, 1);
+            return 1;
+
+        case AVMOpcodePop:
+            _need(e, 1, slow, nslow);
+            _op_mem(e, 1, 0x8b, RCX, R12, S_PTR);
+            _load(e, RDX, 0);
+            _is_immediate(e, RDX, slow, nslow);
+            _set_used(e, -1);
+            return 1;
+
+        case AVMOpcodeSwap:
+            _need(e, 2, slow, nslow);
+            _op_mem(e, 1, 0x8b, RCX, R12, S_PTR);
+            _load(e, RDX, 0);
+            _load(e, RSI, 1);
+            _not_mark(e, RDX, slow, nslow);
+            _not_mark(e, RSI, slow, nslow);
+            _store(e, RSI, 0);
+            _store(e, RDX, 1);
+            return 1;
+
+        default:
+            return 0;
+    }
+}
+
+/*
+ * COMPILER
+ */
+
+typedef struct
+{
+    Emitter        e;
+    const uint8_t *code;
+    size_t         start,
+                   end;
+    size_t        *at;     /* native offset of each instruction, by position */
+    size_t        *fixups; /* pairs of rel32 and target position */
+    uint32_t       nfixups;
+} Compiler;
+
+/* position after the instruction at pos, or 0 when it isn't one */
+static size_t _next(Compiler *c, size_t pos)
+{
+    const AVMOpcodeInfo *info = &OPCODE_INFO[c->code[pos]];
+    size_t               next = pos + 1 + info->operand_bytes;
+    uint32_t             len  = 0;
+    int                  i;
+
+    if (!info->valid || next > c->end)
+        return 0;
+
+    switch (info->operand)
+    {
+        case AVMOperandBlob:
+        case AVMOperandCode:
+        case AVMOperandLoop:
+            for (i=0;i<info->operand_bytes;++i)
+                len = (len << 8) | c->code[pos+1+i];
+            break;
+
+        default:
+            break;
+    }
+
+    return next + len <= c->end? next + len : 0;
+}
+
+static int _is_start(Compiler *c, size_t pos)
+{
+    return pos >= c->start && pos <= c->end && c->at[pos - c->start] != NO_LABEL;
+}
+
+static void _jump(Compiler *c, int cc, size_t target)
+{
+    c->fixups[c->nfixups++] = cc < 0? _jmp(&c->e) : _jcc(&c->e, cc);
+    c->fixups[c->nfixups++] = target;
+}
+
+static void _compile_jump(Compiler *c, AVMOpcode op, size_t pos, size_t next,
+                          const AVMParser *parsers)
+{
+    Emitter *e      = &c->e;
+    size_t   target = next + (int16_t)((c->code[pos+1] << 8) | c->code[pos+2]);
+    size_t   slow[MAX_SLOW_JUMPS];
+    int      nslow  = 0,
+             i;
+
+    if (!_is_start(c, target))
+    {
+        _exit_at(e, pos);
+        return;
+    }
+
+    if (op == AVMOpcodeJmp)
+    {
+        _count(e);
+        _jump(c, -1, target);
+        return;
+    }
+
+    _need(e, 1, slow, &nslow);
+    _op_mem(e, 1, 0x8b, RCX, R12, S_PTR);
+    _load(e, RDX, 0);
+    _is_integer(e, RDX, slow, &nslow);
+    _set_used(e, -1);
+    _count(e);
+    _op_imm8(e, 1, 0xc1, 5, RDX, 32);
+    _op_reg(e, 0, 0x85, RDX, RDX);
+    _jump(c, op == AVMOpcodeJmpZ? CC_E : CC_NE, target);
+    _jump(c, -1, next);
+
+    /* conditions of other types: where the parser went decides */
+    for (i=0;i<nslow;++i)
+        _patch(e, slow[i], e->used);
+
+    _call_parser(e, parsers[op], pos);
+    _count(e);
+    _op_mem(e, 1, 0x8b, RAX, RBX, VM_POS);    /* mov rax, [rbx+pos] */
+    _op_reg(e, 1, 0x01, R13, RAX);            /* add rax, r13 */
+    _mov_imm64(e, RCX, target);
+    _op_reg(e, 1, 0x39, RCX, RAX);            /* cmp rax, rcx */
+    _jump(c, CC_E, target);
+}
+
+static void _compile_insn(Compiler *c, size_t pos, size_t next, const AVMParser *parsers)
+{
+    Emitter  *e  = &c->e;
+    AVMOpcode op = c->code[pos];
+    size_t    slow[MAX_SLOW_JUMPS],
+              done;
+    int       nslow = 0,
+              i;
+
+    if (OPCODE_INFO[op].control)
+    {
+        _exit_at(e, pos);
+        return;
+    }
+
+    if (op == AVMOpcodeJmp || op == AVMOpcodeJmpZ || op == AVMOpcodeJmpNZ)
+    {
+        _compile_jump(c, op, pos, next, parsers);
+        return;
+    }
+
+    if (_fast(e, op, c->code, pos, slow, &nslow))
+    {
+        done = _jmp(e);
+
+        for (i=0;i<nslow;++i)
+            _patch(e, slow[i], e->used);
+
+        _call_parser(e, parsers[op], pos);
+        _patch(e, done, e->used);
+    }
+    else
+    {
+        _call_parser(e, parsers[op], pos);
+    }
+
+    _count(e);
+}
+
+static void _prologue(Emitter *e)
+{
+    _byte(e, 0x53);                           /* push rbx */
+    _byte(e, 0x41); _byte(e, 0x54);           /* push r12 */
+    _byte(e, 0x41); _byte(e, 0x55);           /* push r13 */
+    _op_reg(e, 1, 0x89, RDI, RBX);            /* mov rbx, rdi */
+    _op_mem(e, 1, 0x8b, R12, RBX, VM_STACK);  /* mov r12, [rbx+stack] */
+    _op_reg(e, 1, 0x89, RSI, R13);            /* mov r13, rsi */
+    _byte(e, 0xff); _byte(e, 0xe2);           /* jmp rdx */
+
+    e->epilogue = e->used;
+
+    _byte(e, 0x41); _byte(e, 0x5d);           /* pop r13 */
+    _byte(e, 0x41); _byte(e, 0x5c);           /* pop r12 */
+    _byte(e, 0x5b);                           /* pop rbx */
+    _byte(e, 0xc3);                           /* ret */
+}
+
+/* compiles [start,end) of code, returning its executable copy or NULL */
+static struct _AVMJitBlock* _compile(Compiler *c, const AVMParser *parsers)
+{
+    size_t   pos,
+             next,
+             length = c->end - c->start;
+    uint32_t i;
+
+    for (i=0;i<=length;++i)
+        c->at[i] = NO_LABEL;
+
+    /* instructions up to the first that isn't one, where it stops */
+    for (i=0, pos=c->start; pos<c->end && (next=_next(c,pos)); pos=next, ++i)
+        c->at[pos - c->start] = 0;
+
+    c->at[pos - c->start] = 0;
+
+    /* too short to be worth entering */
+    if (i < MIN_BLOCK_INSNS)
+        return NULL;
+
+    _prologue(&c->e);
+
+    for (pos=c->start; pos<c->end && (next=_next(c,pos)); pos=next)
+    {
+        c->at[pos - c->start] = c->e.used;
+        _compile_insn(c, pos, next, parsers);
+    }
+
+    /* the end, or the first thing the interpreter must report */
+    c->at[pos - c->start] = c->e.used;
+
+    if (pos == c->end)
+    {
+        _op_reg(&c->e, 1, 0x89, RBX, RDI);    /* mov rdi, rbx */
+        _mov_imm64(&c->e, RSI, c->start);
+        _mov_imm64(&c->e, RAX, (uint64_t)(uintptr_t)_avm_native_again);
+        _byte(&c->e, 0xff);                   /* call rax */
+        _byte(&c->e, 0xd0);
+        _op_reg(&c->e, 0, 0x85, RAX, RAX);
+        _jcc_to(&c->e, CC_NE, c->at[0]);
+    }
+
+    _exit_at(&c->e, pos);
+
+    for (i=0;i<c->nfixups;i+=2)
+        _patch(&c->e, c->fixups[i], c->at[c->fixups[i+1] - c->start]);
+
+    if (c->e.failed)
+        return NULL;
+
+    struct _AVMJitBlock *b = malloc(sizeof(*b));
+
+    if (b == NULL)
+        return NULL;
+
+    long page = sysconf(_SC_PAGESIZE);
+
+    b->next = NULL;
+    b->size = (c->e.used + page - 1) & ~(size_t)(page - 1);
+    b->code = mmap(NULL, b->size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (b->code == MAP_FAILED)
+    {
+        free(b);
+        return NULL;
+    }
+
+    memcpy(b->code, c->e.buf, c->e.used);
+
+    if (mprotect(b->code, b->size, PROT_READ | PROT_EXEC))
+    {
+        munmap(b->code, b->size);
+        free(b);
+        return NULL;
+    }
+
+    return b;
+}
+
+static void _perf_map(AVMCode root, struct _AVMJitBlock *b, size_t used,
+                      size_t start, size_t end)
+{
+    char  name[64];
+    FILE *f;
+
+    snprintf(name, sizeof(name), "/tmp/perf-%d.map", (int)getpid());
+
+    if ((f = fopen(name, "a")) != NULL)
+    {
+        fprintf(f, "%lx %zx avm:%p:%zu-%zu\n",
+                (unsigned long)(uintptr_t)b->code, used, (void*)root, start, end);
+        fclose(f);
+    }
+}
+
+/* compiles the block and points the decoded instructions at its entries */
+static void _jit_block(AVM vm, AVMCode root, size_t start, size_t end,
+                       const AVMParser *parsers, const void *enter)
+{
+    struct _AVMDecoded *d = root->decoded;
+    struct _AVMJitCode *j = d->jit;
+    Compiler            c;
+
+    memset(&c, 0, sizeof(c));
+
+    c.code   = (const uint8_t*)root->data;
+    c.start  = start;
+    c.end    = end;
+    c.at     = malloc((end - start + 1) * sizeof(*c.at));
+    c.fixups = malloc((end - start) * 4 * sizeof(*c.fixups));
+
+    struct _AVMJitBlock *b = NULL;
+
+    if (c.at && c.fixups)
+        b = _compile(&c, parsers);
+
+    if (b != NULL)
+    {
+        size_t   pos;
+        AVMJitFn fn = (AVMJitFn)b->code;
+
+        b->next   = j->blocks;
+        j->blocks = b;
+
+        vm->jit.blocks ++;
+        vm->jit.bytes  += c.e.used;
+
+        if (vm->jit.flags & AVM_JIT_PERF_MAP)
+            _perf_map(root, b, c.e.used, start, end);
+
+        /*
+         * The start, and every instruction after a control opcode, unless
+         * it is one itself: entering would hand it straight back.
+         */
+        char   after_control = 1;
+        size_t next;
+
+        for (pos=start; pos<end && (next=_next(&c,pos)); pos=next)
+        {
+            char control = OPCODE_INFO[c.code[pos]].control;
+
+            if (after_control && !control
+             && _avm_jit_entry(j, fn, (uint8_t*)b->code + c.at[pos - start], end))
+            {
+                d->insns[pos].handler = enter;
+                d->insns[pos].operand = j->nentries - 1;
+            }
+
+            after_control = control;
+        }
+    }
+
+    free(c.e.buf);
+    free(c.at);
+    free(c.fixups);
+}
+
+AVMError avm_jit(AVM vm, uint32_t threshold, uint32_t flags)
+{
+    vm->jit.threshold = threshold;
+    vm->jit.flags     = flags;
+
+    return AVM_NO_ERROR;
+}
+
+#else
+
+AVMError avm_jit(AVM vm, uint32_t threshold, uint32_t flags)
+{
+    return threshold? AVM_ERROR_UNIMPLEMENTED : AVM_NO_ERROR;
+}
+
+#endif /* AVM_JIT */
+
+#ifdef AVM_NATIVE
+
+char _avm_jit_entry(struct _AVMJitCode *j, AVMJitFn fn, const void *at, size_t end)
+{
+    if (j->nentries == j->reserved)
+    {
+        uint32_t             reserved = j->reserved? j->reserved * 2 : 16;
+        struct _AVMJitEntry *entries  = realloc(j->entries, reserved*sizeof(*entries));
+
+        if (entries == NULL)
+            return 0;
+
+        j->entries  = entries;
+        j->reserved = reserved;
+    }
+
+    j->entries[j->nentries].fn  = fn;
+    j->entries[j->nentries].at  = at;
+    j->entries[j->nentries].end = end;
+    j->nentries ++;
+
+    return 1;
+}
+
+void _avm_jit_heat(AVM vm, AVMCode root, size_t start, size_t end,
+                   const AVMParser *parsers, const void *enter)
+{
+    struct _AVMDecoded *d = root->decoded;
+
+    if (start >= end || d == NULL)
+        return;
+
+    if (d->jit == NULL)
+    {
+        if ((d->jit = calloc(1, sizeof(*d->jit))) == NULL)
+            return;
+    }
+
+    if (d->jit->heat == NULL)
+    {
+        d->jit->heat = calloc(root->length, sizeof(*d->jit->heat));
+
+        if (d->jit->heat == NULL)
+            return;
+    }
+
+    uint16_t *heat = &d->jit->heat[start];
+
+    /* UINT16_MAX once compiled, or given up on */
+    if (*heat == UINT16_MAX)
+        return;
+
+    /* a block of a loaded module, from its first start */
+    if (*heat == 0 && vm->natives
+     && _avm_native_block(vm, root, start, end, enter))
+    {
+        *heat = UINT16_MAX;
+        return;
+    }
+
+#ifdef AVM_JIT
+    uint32_t threshold = vm->jit.threshold < UINT16_MAX? vm->jit.threshold
+                                                        : UINT16_MAX - 1;
+
+    if (threshold && ++*heat < threshold)
+        return;
+
+    *heat = UINT16_MAX;
+
+    if (threshold)
+        _jit_block(vm, root, start, end, parsers, enter);
+#else
+    *heat = UINT16_MAX;
+#endif
+}
+
+void _avm_jit_free(struct _AVMJitCode *j)
+{
+    if (j)
+    {
+#ifdef AVM_JIT
+        while (j->blocks)
+        {
+            struct _AVMJitBlock *b = j->blocks;
+
+            j->blocks = b->next;
+            munmap(b->code, b->size);
+            free(b);
+        }
+#endif
+
+        free(j->heat);
+        free(j->entries);
+        free(j);
+    }
+}
+
+#else
+
+void _avm_jit_free(struct _AVMJitCode *j)
+{
+}
+
+#endif /* AVM_NATIVE */
+
+void avm_stats_jit(AVM vm, AVMJitStats *stats)
+{
+    stats->blocks  = vm->jit.blocks;
+    stats->bytes   = vm->jit.bytes;
+    stats->natives = vm->jit.natives;
+}
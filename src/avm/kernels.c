@@ -0,0 +1,683 @@
+#include "avm/internals.h"
+
+#include <string.h>
+
+/*
+ * Byte kernels: explode and implode, working on the stack's slots
+ * directly, and the codecs. x86-64 builds use SSE2, which every such CPU
+ * has, and AVX2 or SSE4.2 where cpuid reports them; other builds, and the
+ * ends of runs, go a byte at a time.
+ *
+ * Bytes are integer slots: 1 in the lower half, the byte in the upper one.
+ * A slot holds a byte when masking it leaves just the tag.
+ */
+
+#define BYTE_MASK 0xffffff00ffffffffull
+
+static const char BASE64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const char HEX[] = "0123456789abcdef";
+
+#ifdef AVM_SIMD
+
+#include <immintrin.h>
+
+#define CPU_AVX2  0x01
+#define CPU_SSE42 0x02
+
+static int _cpu()
+{
+    static int cpu = -1;
+
+    if (cpu < 0)
+    {
+        cpu = (__builtin_cpu_supports("avx2")?   CPU_AVX2  : 0)
+            | (__builtin_cpu_supports("sse4.2")? CPU_SSE42 : 0);
+    }
+
+    return cpu;
+}
+
+static int _avx2()
+{
+    return _cpu() & CPU_AVX2;
+}
+
+/* 16 bytes a step, into 4 slots of them at a time */
+static uint32_t _explode_sse2(AVMValue *to, const uint8_t *from, uint32_t n)
+{
+    const __m128i zero = _mm_setzero_si128(),
+                  tag  = _mm_set1_epi32(AVM_VALUE_TAG_INTEGER);
+    uint32_t      done = 0;
+
+    for (; n - done >= 16; done += 16)
+    {
+        __m128i b = _mm_loadu_si128((const __m128i*)(from + n - done - 16)),
+                w[2],
+                d;
+        int     i;
+
+        w[0] = _mm_unpacklo_epi8(b, zero);
+        w[1] = _mm_unpackhi_epi8(b, zero);
+
+        /* the last byte first */
+        for (i=0;i<4;++i)
+        {
+            d = (i & 1)? _mm_unpacklo_epi16(w[1 - i/2], zero)
+                       : _mm_unpackhi_epi16(w[1 - i/2], zero);
+            d = _mm_shuffle_epi32(d, _MM_SHUFFLE(0,1,2,3));
+
+            _mm_storeu_si128((__m128i*)(to + done + 4*i),     _mm_unpacklo_epi32(tag, d));
+            _mm_storeu_si128((__m128i*)(to + done + 4*i + 2), _mm_unpackhi_epi32(tag, d));
+        }
+    }
+
+    return done;
+}
+
+/* the upper halves of a (two slots) then b, last slot first */
+static inline __m128i _uppers(__m128i a, __m128i b)
+{
+    return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(b),
+                                           _mm_castsi128_ps(a),
+                                           _MM_SHUFFLE(1,3,1,3)));
+}
+
+/* 16 slots a step: 0 when one of them isn't a byte */
+static int _implode_sse2(uint8_t *to, const AVMValue *from, uint32_t n, uint32_t *done)
+{
+    const __m128i mask = _mm_set1_epi64x(BYTE_MASK),
+                  tag  = _mm_set1_epi64x(AVM_VALUE_TAG_INTEGER);
+
+    for (*done=0; n - *done >= 16; *done += 16)
+    {
+        const __m128i *p = (const __m128i*)(from + n - *done - 16);
+        __m128i        v[8],
+                       ok = _mm_set1_epi32(-1);
+        int            i;
+
+        for (i=0;i<8;++i)
+        {
+            v[i] = _mm_loadu_si128(p + i);
+            ok   = _mm_and_si128(ok, _mm_cmpeq_epi32(_mm_and_si128(v[i], mask), tag));
+        }
+
+        if (_mm_movemask_epi8(ok) != 0xffff)
+            return 0;
+
+        __m128i hi = _mm_packs_epi32(_uppers(v[6], v[7]), _uppers(v[4], v[5])),
+                lo = _mm_packs_epi32(_uppers(v[2], v[3]), _uppers(v[0], v[1]));
+
+        _mm_storeu_si128((__m128i*)(to + *done), _mm_packus_epi16(hi, lo));
+    }
+
+    return 1;
+}
+
+/* 4 bytes a step, into 4 slots */
+__attribute__((target("avx2")))
+static uint32_t _explode_avx2(AVMValue *to, const uint8_t *from, uint32_t n)
+{
+    const __m256i tag  = _mm256_set1_epi64x(AVM_VALUE_TAG_INTEGER);
+    uint32_t      done = 0;
+
+    for (; n - done >= 4; done += 4)
+    {
+        int32_t b;
+
+        memcpy(&b, from + n - done - 4, 4);
+
+        __m256i v = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(b));
+
+        v = _mm256_or_si256(_mm256_slli_epi64(v, 32), tag);
+        v = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(0,1,2,3));
+
+        _mm256_storeu_si256((__m256i*)(to + done), v);
+    }
+
+    return done;
+}
+
+__attribute__((target("avx2")))
+static int _implode_avx2(uint8_t *to, const AVMValue *from, uint32_t n, uint32_t *done)
+{
+    const __m256i mask  = _mm256_set1_epi64x(BYTE_MASK),
+                  tag   = _mm256_set1_epi64x(AVM_VALUE_TAG_INTEGER),
+                  upper = _mm256_setr_epi32(7,5,3,1,7,5,3,1);
+
+    for (*done=0; n - *done >= 16; *done += 16)
+    {
+        const __m256i *p = (const __m256i*)(from + n - *done - 16);
+        __m256i        v[4],
+                       ok = _mm256_set1_epi32(-1);
+        __m128i        u[4];
+        int            i;
+
+        for (i=0;i<4;++i)
+        {
+            v[i] = _mm256_loadu_si256(p + i);
+            ok   = _mm256_and_si256(ok, _mm256_cmpeq_epi64(_mm256_and_si256(v[i], mask), tag));
+            u[i] = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(v[i], upper));
+        }
+
+        if (_mm256_movemask_epi8(ok) != -1)
+            return 0;
+
+        __m128i hi = _mm_packs_epi32(u[3], u[2]),
+                lo = _mm_packs_epi32(u[1], u[0]);
+
+        _mm_storeu_si128((__m128i*)(to + *done), _mm_packus_epi16(hi, lo));
+    }
+
+    return 1;
+}
+
+/*
+ * Base64 after Wojciech Mula's: 24 bytes to 32 characters a step. Each
+ * 3 bytes are spread over a dword, cut in 6 bits with multiplications
+ * and mapped to characters through an offset looked up by range.
+ */
+__attribute__((target("avx2")))
+static uint32_t _base64_encode_avx2(char *to, const uint8_t *from, uint32_t n)
+{
+    const __m256i spread = _mm256_setr_epi8(1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10,
+                                            1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10),
+                  offset = _mm256_setr_epi8('a'-26, '0'-52, '0'-52, '0'-52, '0'-52,
+                                            '0'-52, '0'-52, '0'-52, '0'-52, '0'-52,
+                                            '0'-52, '+'-62, '/'-63, 'A', 0, 0,
+                                            'a'-26, '0'-52, '0'-52, '0'-52, '0'-52,
+                                            '0'-52, '0'-52, '0'-52, '0'-52, '0'-52,
+                                            '0'-52, '+'-62, '/'-63, 'A', 0, 0);
+    uint32_t      done = 0;
+
+    /* the upper lane reads 16 bytes from 12 on */
+    for (; n - done >= 28; done += 24)
+    {
+        __m256i v = _mm256_inserti128_si256(
+                        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(from + done))),
+                        _mm_loadu_si128((const __m128i*)(from + done + 12)), 1);
+
+        v = _mm256_shuffle_epi8(v, spread);
+        v = _mm256_or_si256(
+                _mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00)),
+                                   _mm256_set1_epi32(0x04000040)),
+                _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0)),
+                                   _mm256_set1_epi32(0x01000010)));
+
+        /* 13 for A-Z, 0 for a-z, 1-10 for digits, 11 and 12 for + and / */
+        __m256i r = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+
+        r = _mm256_or_si256(r, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), v),
+                                                _mm256_set1_epi8(13)));
+        v = _mm256_add_epi8(v, _mm256_shuffle_epi8(offset, r));
+
+        _mm256_storeu_si256((__m256i*)(to + done/3*4), v);
+    }
+
+    return done;
+}
+
+/* 32 characters to 24 bytes a step, up to the first one that isn't base64 */
+__attribute__((target("avx2")))
+static uint32_t _base64_decode_avx2(uint8_t *to, const char *from, uint32_t n)
+{
+    /* by high nibble: what to add, and which low nibbles are valid */
+    const __m256i shift = _mm256_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71,
+                                           0, 0, 0, 0, 0, 0, 0, 0,
+                                           0, 0, 19, 4, -65, -65, -71, -71,
+                                           0, 0, 0, 0, 0, 0, 0, 0),
+                  valid = _mm256_setr_epi8(0xa8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8,
+                                           0xf8, 0xf8, 0xf0, 0x54, 0x50, 0x50, 0x50, 0x54,
+                                           0xa8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8,
+                                           0xf8, 0xf8, 0xf0, 0x54, 0x50, 0x50, 0x50, 0x54),
+                  bit   = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128,
+                                           0, 0, 0, 0, 0, 0, 0, 0,
+                                           1, 2, 4, 8, 16, 32, 64, -128,
+                                           0, 0, 0, 0, 0, 0, 0, 0),
+                  pack  = _mm256_setr_epi8(2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1,
+                                           2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1),
+                  nibble = _mm256_set1_epi8(0x0f);
+    uint32_t      done = 0;
+
+    for (; n - done >= 32; done += 32)
+    {
+        __m256i c  = _mm256_loadu_si256((const __m256i*)(from + done)),
+                hi = _mm256_and_si256(_mm256_srli_epi32(c, 4), nibble),
+                lo = _mm256_and_si256(c, nibble);
+
+        __m256i bad = _mm256_cmpeq_epi8(
+                          _mm256_and_si256(_mm256_shuffle_epi8(valid, lo),
+                                           _mm256_shuffle_epi8(bit, hi)),
+                          _mm256_setzero_si256());
+
+        if (_mm256_movemask_epi8(bad))
+            break;
+
+        __m256i v = _mm256_add_epi8(c,
+                        _mm256_blendv_epi8(_mm256_shuffle_epi8(shift, hi),
+                                           _mm256_set1_epi8(16),
+                                           _mm256_cmpeq_epi8(c, _mm256_set1_epi8('/'))));
+
+        /* 4 x 6 bits to 3 bytes a dword, then the 12 bytes of each lane */
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, pack);
+        v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0,1,2,4,5,6,7,7));
+
+        _mm_storeu_si128((__m128i*)(to + done/4*3), _mm256_castsi256_si128(v));
+        _mm_storel_epi64((__m128i*)(to + done/4*3 + 16), _mm256_extracti128_si256(v, 1));
+    }
+
+    return done;
+}
+
+/* nibbles as characters, 16 bytes a step */
+static uint32_t _hex_encode_sse2(char *to, const uint8_t *from, uint32_t n)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0f),
+                  nine   = _mm_set1_epi8(9),
+                  zero   = _mm_set1_epi8('0'),
+                  letter = _mm_set1_epi8('a' - '0' - 10);
+    uint32_t      done   = 0;
+
+    for (; n - done >= 16; done += 16)
+    {
+        __m128i b  = _mm_loadu_si128((const __m128i*)(from + done)),
+                hi = _mm_and_si128(_mm_srli_epi16(b, 4), nibble),
+                lo = _mm_and_si128(b, nibble),
+                c[2];
+        int     i;
+
+        c[0] = _mm_unpacklo_epi8(hi, lo);
+        c[1] = _mm_unpackhi_epi8(hi, lo);
+
+        for (i=0;i<2;++i)
+        {
+            c[i] = _mm_add_epi8(_mm_add_epi8(c[i], zero),
+                                _mm_and_si128(_mm_cmpgt_epi8(c[i], nine), letter));
+            _mm_storeu_si128((__m128i*)(to + 2*done + 16*i), c[i]);
+        }
+    }
+
+    return done;
+}
+
+/* the nibbles of 16 characters, in the lower byte of each word when valid */
+static inline int _hex_nibbles(__m128i c, __m128i *v)
+{
+    __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0')),
+            l = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a')),
+            digit  = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d),
+            letter = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+
+    if (_mm_movemask_epi8(_mm_or_si128(digit, letter)) != 0xffff)
+        return 0;
+
+    *v = _mm_or_si128(_mm_and_si128(digit, d),
+                      _mm_and_si128(letter, _mm_add_epi8(l, _mm_set1_epi8(10))));
+    *v = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(*v, 4), _mm_set1_epi16(0xf0)),
+                      _mm_srli_epi16(*v, 8));
+    return 1;
+}
+
+/* 32 characters to 16 bytes a step, up to the first one that isn't hex */
+static uint32_t _hex_decode_sse2(uint8_t *to, const char *from, uint32_t n)
+{
+    uint32_t done = 0;
+
+    for (; n - done >= 32; done += 32)
+    {
+        __m128i a, b;
+
+        if (!_hex_nibbles(_mm_loadu_si128((const __m128i*)(from + done)), &a)
+         || !_hex_nibbles(_mm_loadu_si128((const __m128i*)(from + done + 16)), &b))
+            break;
+
+        _mm_storeu_si128((__m128i*)(to + done/2), _mm_packus_epi16(a, b));
+    }
+
+    return done;
+}
+
+__attribute__((target("sse4.2")))
+static uint32_t _crc32c_sse42(uint32_t crc, const uint8_t *from, uint32_t n, uint32_t *done)
+{
+    uint64_t c = crc;
+
+    for (*done=0; n - *done >= 8; *done += 8)
+    {
+        uint64_t v;
+
+        memcpy(&v, from + *done, 8);
+        c = _mm_crc32_u64(c, v);
+    }
+
+    return c;
+}
+
+/*
+ * Substrings, after Wojciech Mula's generic SIMD search: the positions
+ * where both the first and the last byte of the needle match, 16 or 32 at
+ * a time, are the only ones compared. m > 1; *i is where it stopped.
+ */
+static int64_t _find_sse2(const uint8_t *h, uint32_t n,
+                          const uint8_t *needle, uint32_t m, uint32_t *i)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]),
+                  last  = _mm_set1_epi8(needle[m-1]);
+
+    for (*i=0; n - *i >= m - 1 + 16; *i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)(h + *i)),
+                b = _mm_loadu_si128((const __m128i*)(h + *i + m - 1));
+        int     mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first),
+                                                       _mm_cmpeq_epi8(b, last)));
+
+        for (; mask; mask &= mask - 1)
+        {
+            uint32_t at = *i + __builtin_ctz(mask);
+
+            if (!memcmp(h + at + 1, needle + 1, m - 2))
+                return at;
+        }
+    }
+
+    return -1;
+}
+
+__attribute__((target("avx2")))
+static int64_t _find_avx2(const uint8_t *h, uint32_t n,
+                          const uint8_t *needle, uint32_t m, uint32_t *i)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]),
+                  last  = _mm256_set1_epi8(needle[m-1]);
+
+    for (*i=0; n - *i >= m - 1 + 32; *i += 32)
+    {
+        __m256i  a = _mm256_loadu_si256((const __m256i*)(h + *i)),
+                 b = _mm256_loadu_si256((const __m256i*)(h + *i + m - 1));
+        uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first),
+                                                              _mm256_cmpeq_epi8(b, last)));
+
+        for (; mask; mask &= mask - 1)
+        {
+            uint32_t at = *i + __builtin_ctz(mask);
+
+            if (!memcmp(h + at + 1, needle + 1, m - 2))
+                return at;
+        }
+    }
+
+    return -1;
+}
+
+#endif /* AVM_SIMD */
+
+/* n slots of the bytes in from, the last byte first, as explode pushes them */
+void _avm_explode(AVMValue *to, const uint8_t *from, uint32_t n)
+{
+    uint32_t i = 0;
+
+#ifdef AVM_SIMD
+    i = _avx2()? _explode_avx2(to, from, n) : _explode_sse2(to, from, n);
+#endif
+
+    for (; i<n; ++i)
+        to[i] = AVM_VALUE_FROM_INTEGER(from[n-1-i]);
+}
+
+/* the bytes of n slots, the last slot first; 0 when one isn't a byte */
+int _avm_implode(uint8_t *to, const AVMValue *from, uint32_t n)
+{
+    uint32_t i = 0;
+
+#ifdef AVM_SIMD
+    if (!(_avx2()? _implode_avx2(to, from, n, &i) : _implode_sse2(to, from, n, &i)))
+        return 0;
+#endif
+
+    for (; i<n; ++i)
+    {
+        AVMValue v = from[n-1-i];
+
+        if ((v & BYTE_MASK) != AVM_VALUE_TAG_INTEGER)
+            return 0;
+
+        to[i] = AVM_VALUE_INTEGER(v);
+    }
+
+    return 1;
+}
+
+/* 4 characters for each 3 bytes or less, padded with = */
+void _avm_base64_encode(char *to, const uint8_t *from, uint32_t n)
+{
+    uint32_t i = 0;
+
+#ifdef AVM_SIMD
+    if (_avx2())
+        i = _base64_encode_avx2(to, from, n);
+#endif
+
+    for (to += i/3*4; n - i >= 3; i += 3, to += 4)
+    {
+        uint32_t v = from[i] << 16 | from[i+1] << 8 | from[i+2];
+
+        to[0] = BASE64[v >> 18];
+        to[1] = BASE64[v >> 12 & 0x3f];
+        to[2] = BASE64[v >> 6  & 0x3f];
+        to[3] = BASE64[v       & 0x3f];
+    }
+
+    if (n - i)
+    {
+        uint32_t v = from[i] << 16 | (n - i > 1? from[i+1] << 8 : 0);
+
+        to[0] = BASE64[v >> 18];
+        to[1] = BASE64[v >> 12 & 0x3f];
+        to[2] = n - i > 1? BASE64[v >> 6 & 0x3f] : '=';
+        to[3] = '=';
+    }
+}
+
+static int _base64_value(char c)
+{
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+')             return 62;
+    if (c == '/')             return 63;
+    return -1;
+}
+
+/*
+ * Bytes of n characters of base64, a multiple of 4 with = padding the last
+ * ones: 0 unless length is what they decode to and they are all valid.
+ */
+int _avm_base64_decode(uint8_t *to, const char *from, uint32_t n, uint32_t *length)
+{
+    uint32_t i = 0,
+             pad;
+
+    if (n % 4)
+        return 0;
+
+    pad     = (n && from[n-1] == '=') + (n && from[n-2] == '=');
+    *length = n/4*3 - pad;
+
+#ifdef AVM_SIMD
+    if (_avx2())
+        i = _base64_decode_avx2(to, from, n - 4*(pad > 0));
+#endif
+
+    for (to += i/4*3; i < n; i += 4)
+    {
+        int      a = _base64_value(from[i]),
+                 b = _base64_value(from[i+1]),
+                 c = _base64_value(from[i+2]),
+                 d = _base64_value(from[i+3]);
+        uint32_t left = n - i == 4? 3 - pad : 3;
+
+        if (a < 0 || b < 0 || (c < 0 && left > 1) || (d < 0 && left > 2))
+            return 0;
+
+        uint32_t v = a << 18 | b << 12 | (c < 0? 0 : c << 6) | (d < 0? 0 : d);
+
+        *to++ = v >> 16;
+        if (left > 1) *to++ = v >> 8;
+        if (left > 2) *to++ = v;
+    }
+
+    return 1;
+}
+
+/* 2 lower case characters a byte */
+void _avm_hex_encode(char *to, const uint8_t *from, uint32_t n)
+{
+    uint32_t i = 0;
+
+#ifdef AVM_SIMD
+    i = _hex_encode_sse2(to, from, n);
+#endif
+
+    for (; i<n; ++i)
+    {
+        to[2*i]   = HEX[from[i] >> 4];
+        to[2*i+1] = HEX[from[i] & 0x0f];
+    }
+}
+
+static int _hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/* n/2 bytes of n hex characters, either case: 0 when one isn't */
+int _avm_hex_decode(uint8_t *to, const char *from, uint32_t n)
+{
+    uint32_t i = 0;
+
+    if (n % 2)
+        return 0;
+
+#ifdef AVM_SIMD
+    i = _hex_decode_sse2(to, from, n);
+#endif
+
+    for (; i<n; i+=2)
+    {
+        int h = _hex_value(from[i]),
+            l = _hex_value(from[i+1]);
+
+        if (h < 0 || l < 0)
+            return 0;
+
+        to[i/2] = h << 4 | l;
+    }
+
+    return 1;
+}
+
+/* where needle first is in h, or -1 */
+int64_t _avm_find(const uint8_t *h, uint32_t n, const uint8_t *needle, uint32_t m)
+{
+    const uint8_t *p;
+    uint32_t       i = 0;
+
+    if (m == 0 || m > n)
+        return m? -1 : 0;
+
+    if (m == 1)
+    {
+        p = memchr(h, needle[0], n);
+        return p? p - h : -1;
+    }
+
+#ifdef AVM_SIMD
+    int64_t at = _avx2()? _find_avx2(h, n, needle, m, &i)
+                        : _find_sse2(h, n, needle, m, &i);
+
+    if (at >= 0)
+        return at;
+#endif
+
+    for (; (p = memchr(h + i, needle[0], n - m + 1 - i)) != NULL; i = p - h + 1)
+    {
+        if (!memcmp(p + 1, needle + 1, m - 1))
+            return p - h;
+    }
+
+    return -1;
+}
+
+/*
+ * Castagnoli's polynomial 0x82f63b78, reflected, as iSCSI and SSE4.2 have
+ * it: what a byte adds to the CRC, for each value of the byte
+ */
+static const uint32_t CRC32C[256] =
+{
+    0x00000000, 0xf26b8303, 0xe13b70f7, 0x1350f3f4, 0xc79a971f, 0x35f1141c,
+    0x26a1e7e8, 0xd4ca64eb, 0x8ad958cf, 0x78b2dbcc, 0x6be22838, 0x9989ab3b,
+    0x4d43cfd0, 0xbf284cd3, 0xac78bf27, 0x5e133c24, 0x105ec76f, 0xe235446c,
+    0xf165b798, 0x030e349b, 0xd7c45070, 0x25afd373, 0x36ff2087, 0xc494a384,
+    0x9a879fa0, 0x68ec1ca3, 0x7bbcef57, 0x89d76c54, 0x5d1d08bf, 0xaf768bbc,
+    0xbc267848, 0x4e4dfb4b, 0x20bd8ede, 0xd2d60ddd, 0xc186fe29, 0x33ed7d2a,
+    0xe72719c1, 0x154c9ac2, 0x061c6936, 0xf477ea35, 0xaa64d611, 0x580f5512,
+    0x4b5fa6e6, 0xb93425e5, 0x6dfe410e, 0x9f95c20d, 0x8cc531f9, 0x7eaeb2fa,
+    0x30e349b1, 0xc288cab2, 0xd1d83946, 0x23b3ba45, 0xf779deae, 0x05125dad,
+    0x1642ae59, 0xe4292d5a, 0xba3a117e, 0x4851927d, 0x5b016189, 0xa96ae28a,
+    0x7da08661, 0x8fcb0562, 0x9c9bf696, 0x6ef07595, 0x417b1dbc, 0xb3109ebf,
+    0xa0406d4b, 0x522bee48, 0x86e18aa3, 0x748a09a0, 0x67dafa54, 0x95b17957,
+    0xcba24573, 0x39c9c670, 0x2a993584, 0xd8f2b687, 0x0c38d26c, 0xfe53516f,
+    0xed03a29b, 0x1f682198, 0x5125dad3, 0xa34e59d0, 0xb01eaa24, 0x42752927,
+    0x96bf4dcc, 0x64d4cecf, 0x77843d3b, 0x85efbe38, 0xdbfc821c, 0x2997011f,
+    0x3ac7f2eb, 0xc8ac71e8, 0x1c661503, 0xee0d9600, 0xfd5d65f4, 0x0f36e6f7,
+    0x61c69362, 0x93ad1061, 0x80fde395, 0x72966096, 0xa65c047d, 0x5437877e,
+    0x4767748a, 0xb50cf789, 0xeb1fcbad, 0x197448ae, 0x0a24bb5a, 0xf84f3859,
+    0x2c855cb2, 0xdeeedfb1, 0xcdbe2c45, 0x3fd5af46, 0x7198540d, 0x83f3d70e,
+    0x90a324fa, 0x62c8a7f9, 0xb602c312, 0x44694011, 0x5739b3e5, 0xa55230e6,
+    0xfb410cc2, 0x092a8fc1, 0x1a7a7c35, 0xe811ff36, 0x3cdb9bdd, 0xceb018de,
+    0xdde0eb2a, 0x2f8b6829, 0x82f63b78, 0x709db87b, 0x63cd4b8f, 0x91a6c88c,
+    0x456cac67, 0xb7072f64, 0xa457dc90, 0x563c5f93, 0x082f63b7, 0xfa44e0b4,
+    0xe9141340, 0x1b7f9043, 0xcfb5f4a8, 0x3dde77ab, 0x2e8e845f, 0xdce5075c,
+    0x92a8fc17, 0x60c37f14, 0x73938ce0, 0x81f80fe3, 0x55326b08, 0xa759e80b,
+    0xb4091bff, 0x466298fc, 0x1871a4d8, 0xea1a27db, 0xf94ad42f, 0x0b21572c,
+    0xdfeb33c7, 0x2d80b0c4, 0x3ed04330, 0xccbbc033, 0xa24bb5a6, 0x502036a5,
+    0x4370c551, 0xb11b4652, 0x65d122b9, 0x97baa1ba, 0x84ea524e, 0x7681d14d,
+    0x2892ed69, 0xdaf96e6a, 0xc9a99d9e, 0x3bc21e9d, 0xef087a76, 0x1d63f975,
+    0x0e330a81, 0xfc588982, 0xb21572c9, 0x407ef1ca, 0x532e023e, 0xa145813d,
+    0x758fe5d6, 0x87e466d5, 0x94b49521, 0x66df1622, 0x38cc2a06, 0xcaa7a905,
+    0xd9f75af1, 0x2b9cd9f2, 0xff56bd19, 0x0d3d3e1a, 0x1e6dcdee, 0xec064eed,
+    0xc38d26c4, 0x31e6a5c7, 0x22b65633, 0xd0ddd530, 0x0417b1db, 0xf67c32d8,
+    0xe52cc12c, 0x1747422f, 0x49547e0b, 0xbb3ffd08, 0xa86f0efc, 0x5a048dff,
+    0x8ecee914, 0x7ca56a17, 0x6ff599e3, 0x9d9e1ae0, 0xd3d3e1ab, 0x21b862a8,
+    0x32e8915c, 0xc083125f, 0x144976b4, 0xe622f5b7, 0xf5720643, 0x07198540,
+    0x590ab964, 0xab613a67, 0xb831c993, 0x4a5a4a90, 0x9e902e7b, 0x6cfbad78,
+    0x7fab5e8c, 0x8dc0dd8f, 0xe330a81a, 0x115b2b19, 0x020bd8ed, 0xf0605bee,
+    0x24aa3f05, 0xd6c1bc06, 0xc5914ff2, 0x37faccf1, 0x69e9f0d5, 0x9b8273d6,
+    0x88d28022, 0x7ab90321, 0xae7367ca, 0x5c18e4c9, 0x4f48173d, 0xbd23943e,
+    0xf36e6f75, 0x0105ec76, 0x12551f82, 0xe03e9c81, 0x34f4f86a, 0xc69f7b69,
+    0xd5cf889d, 0x27a40b9e, 0x79b737ba, 0x8bdcb4b9, 0x988c474d, 0x6ae7c44e,
+    0xbe2da0a5, 0x4c4623a6, 0x5f16d052, 0xad7d5351
+};
+
+uint32_t _avm_crc32c(uint32_t crc, const uint8_t *from, uint32_t n)
+{
+    uint32_t i = 0;
+
+    crc = ~crc;
+
+#ifdef AVM_SIMD
+    if (_cpu() & CPU_SSE42)
+        crc = _crc32c_sse42(crc, from, n, &i);
+#endif
+
+    for (; i<n; ++i)
+        crc = CRC32C[(crc ^ from[i]) & 0xff] ^ (crc >> 8);
+
+    return ~crc;
+}
@@ -0,0 +1,165 @@
+#include "avm/native.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef AVM_NATIVE
+
+#include <dlfcn.h>
+
+/*
+ * Loaded modules stay mapped once the VM is gone: decoded programs that
+ * outlive it may still enter their blocks.
+ */
+struct _AVMNativeLib
+{
+    struct _AVMNativeLib  *next;
+    const AVMNativeModule *module;
+};
+
+extern AVMParser PARSER_TABLE[256];
+
+static const AVMNativeHost HOST = { PARSER_TABLE, _avm_native_again };
+
+/*
+ * Loops the topmost frame when it runs the block at start, as _frame_end
+ * does: 1 when it goes on from start. The interpreter ends the frame
+ * otherwise, or grows the stack for the next value of a for.
+ */
+int _avm_native_again(AVM vm, size_t start)
+{
+    struct _AVMFrame *f = &vm->runtime.frames[vm->runtime.depth-1];
+    AVMStack          s = vm->runtime.stack;
+
+    if (f->start + (size_t)(vm->runtime.code - vm->runtime.root->data) != start)
+        return 0;
+
+    switch (f->kind)
+    {
+        case AVMFrameRepeat:
+            if (f->count <= 1)
+                return 0;
+
+            f->count --;
+            return 1;
+
+        case AVMFrameFor:
+        {
+            int32_t i = f->count + f->step;
+
+            if ( !((f->step>0 && i<=f->limit) || (f->step<0 && i>=f->limit))
+              || s->used == s->reserved )
+                return 0;
+
+            s->ptr[s->used++] = AVM_VALUE_FROM_INTEGER(i);
+            f->count = i;
+            return 1;
+        }
+
+        default:
+            return 0;
+    }
+}
+
+static void _bind(AVM vm, AVMCode root, const AVMNativeBlock *b,
+                  size_t start, size_t end, const void *enter)
+{
+    struct _AVMDecoded *d = root->decoded;
+    uint32_t            i;
+
+    for (i=0;i<b->nentries;++i)
+    {
+        size_t pos = start + b->entries[i];
+
+        if (pos < end
+         && _avm_jit_entry(d->jit, b->fn, (const void*)(uintptr_t)b->entries[i], end))
+        {
+            d->insns[pos].handler = enter;
+            d->insns[pos].operand = d->jit->nentries - 1;
+        }
+    }
+
+    vm->jit.natives ++;
+}
+
+char _avm_native_block(AVM vm, AVMCode root, size_t start, size_t end,
+                       const void *enter)
+{
+    const char           *code   = root->data + start;
+    size_t                length = end - start;
+    struct _AVMNativeLib *l;
+    uint32_t              i;
+
+    for (l=vm->natives; l; l=l->next)
+    {
+        for (i=0;i<l->module->nblocks;++i)
+        {
+            const AVMNativeBlock *b = &l->module->blocks[i];
+
+            if (b->length == length && !memcmp(b->code, code, length))
+            {
+                _bind(vm, root, b, start, end, enter);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+AVMError avm_load_native(AVM vm, const char *path)
+{
+    void                  *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    const AVMNativeModule *m;
+
+    if (handle == NULL)
+        return AVM_ERROR_INVALID_ARG;
+
+    m = dlsym(handle, "avm_native_module");
+
+    if (m == NULL || m->version != AVM_VERSION || m->abi != AVM_NATIVE_ABI)
+    {
+        dlclose(handle);
+        return AVM_ERROR_INVALID_ARG;
+    }
+
+    struct _AVMNativeLib *l = malloc(sizeof(*l));
+
+    if (l == NULL)
+    {
+        dlclose(handle);
+        return AVM_ERROR_NO_MEM;
+    }
+
+    *m->host = &HOST;
+
+    l->next     = vm->natives;
+    l->module   = m;
+    vm->natives = l;
+
+    return AVM_NO_ERROR;
+}
+
+void _avm_native_free(struct _AVMNativeLib *l)
+{
+    while (l)
+    {
+        struct _AVMNativeLib *next = l->next;
+
+        free(l);
+        l = next;
+    }
+}
+
+#else
+
+AVMError avm_load_native(AVM vm, const char *path)
+{
+    return AVM_ERROR_UNIMPLEMENTED;
+}
+
+void _avm_native_free(struct _AVMNativeLib *l)
+{
+}
+
+#endif /* AVM_NATIVE */
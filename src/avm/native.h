@@ -0,0 +1,236 @@
+#ifndef AVM_NATIVE_H_INCLUDED
+#define AVM_NATIVE_H_INCLUDED
+
+#include "avm/internals.h"
+#include "avm/generated/opcodes.h"
+
+/*
+ * Native modules: what avm2c translates a program to, built as a shared
+ * object and loaded with avm_load_native. Each block of the program (the
+ * program itself, its code literals and its inline loop bodies) is a C
+ * function entered like compiled JIT code, wherever a frame runs the same
+ * bytes: at is the offset in the block to start from, delta as for the
+ * JIT. The module calls back into the VM only through its host, which the
+ * loader fills in.
+ */
+
+/* bumped whenever modules must be translated again */
+#define AVM_NATIVE_ABI 2
+
+typedef struct
+{
+    const AVMParser *parsers;
+    int (* again)(AVM, size_t start);
+} AVMNativeHost;
+
+typedef struct
+{
+    const uint8_t  *code;
+    uint32_t        length;
+    AVMJitFn        fn;
+    const uint32_t *entries; /* offsets it can be entered at */
+    uint32_t        nentries;
+} AVMNativeBlock;
+
+typedef struct
+{
+    uint16_t              version; /* AVM_VERSION */
+    uint16_t              abi;     /* AVM_NATIVE_ABI */
+    const AVMNativeHost **host;
+    const AVMNativeBlock *blocks;
+    uint32_t              nblocks;
+} AVMNativeModule; /* exported as avm_native_module */
+
+/*
+ * Fast paths of the run.c handlers for immediate values: 1 when done, 0
+ * when the parser has to run instead, with nothing changed.
+ */
+
+static inline int _avm_native_push(AVMStack s, AVMValue v)
+{
+    if (s->used == s->reserved)
+        return 0;
+
+    s->ptr[s->used++] = v;
+    return 1;
+}
+
+/* as _compare for integers: the sign of a - b, wrapping around */
+static inline int _avm_native_binary(AVMStack s, AVMOpcode op)
+{
+    if (s->used < 2)
+        return 0;
+
+    AVMValue a = s->ptr[s->used-2],
+             b = s->ptr[s->used-1];
+
+    if (!AVM_VALUE_IS_INTEGER(a) || !AVM_VALUE_IS_INTEGER(b))
+        return 0;
+
+    uint32_t x = (uint32_t)AVM_VALUE_INTEGER(a),
+             y = (uint32_t)AVM_VALUE_INTEGER(b),
+             r;
+    int32_t  d = (int32_t)(x - y);
+
+    switch (op)
+    {
+        case AVMOpcodeAdd: r = x + y;  break;
+        case AVMOpcodeSub: r = x - y;  break;
+        case AVMOpcodeMul: r = x * y;  break;
+        case AVMOpcodeAnd: r = x & y;  break;
+        case AVMOpcodeOr:  r = x | y;  break;
+        case AVMOpcodeEq:  r = d == 0; break;
+        case AVMOpcodeNeq: r = d != 0; break;
+        case AVMOpcodeLt:  r = d <  0; break;
+        case AVMOpcodeLte: r = d <= 0; break;
+        case AVMOpcodeGt:  r = d >  0; break;
+        case AVMOpcodeGte: r = d >= 0; break;
+        default:           return 0;
+    }
+
+    s->ptr[s->used-2] = AVM_VALUE_FROM_INTEGER(r);
+    s->used --;
+    return 1;
+}
+
+static inline int _avm_native_unary(AVMStack s, AVMOpcode op)
+{
+    if (s->used < 1)
+        return 0;
+
+    AVMValue a = s->ptr[s->used-1];
+
+    if (!AVM_VALUE_IS_INTEGER(a))
+        return 0;
+
+    uint32_t x = (uint32_t)AVM_VALUE_INTEGER(a),
+             r;
+
+    switch (op)
+    {
+        case AVMOpcodeInc:  r = x + 1;  break;
+        case AVMOpcodeDec:  r = x - 1;  break;
+        case AVMOpcodeNeqZ: r = x != 0; break;
+        case AVMOpcodeEqZ:
+        case AVMOpcodeNot:  r = x == 0; break;
+        default:            return 0;
+    }
+
+    s->ptr[s->used-1] = AVM_VALUE_FROM_INTEGER(r);
+    return 1;
+}
+
+/*
+ * Copies and pops own objects: those go through the parser, and so do
+ * marks moved, for the stack to index them.
+ */
+static inline int _avm_native_dup(AVMStack s)
+{
+    if (s->used < 1 || s->used == s->reserved
+     || AVM_VALUE_IS_OBJECT(s->ptr[s->used-1])
+     || AVM_VALUE_IS_MARK(s->ptr[s->used-1]))
+        return 0;
+
+    s->ptr[s->used] = s->ptr[s->used-1];
+    s->used ++;
+    return 1;
+}
+
+static inline int _avm_native_pop(AVMStack s)
+{
+    if (s->used < 1 || AVM_VALUE_IS_OBJECT(s->ptr[s->used-1]))
+        return 0;
+
+    s->used --;
+    return 1;
+}
+
+static inline int _avm_native_swap(AVMStack s)
+{
+    if (s->used < 2
+     || AVM_VALUE_IS_MARK(s->ptr[s->used-1])
+     || AVM_VALUE_IS_MARK(s->ptr[s->used-2]))
+        return 0;
+
+    AVMValue v = s->ptr[s->used-1];
+
+    s->ptr[s->used-1] = s->ptr[s->used-2];
+    s->ptr[s->used-2] = v;
+    return 1;
+}
+
+/* pops the integer a conditional jump tests: 0 or 1, or -1 for the parser */
+static inline int _avm_native_test(AVMStack s)
+{
+    if (s->used < 1 || !AVM_VALUE_IS_INTEGER(s->ptr[s->used-1]))
+        return -1;
+
+    return AVM_VALUE_INTEGER(s->ptr[--s->used]) != 0;
+}
+
+/*
+ * What avm2c writes a block with. Positions are offsets in the block;
+ * base is where the block starts in the running frame's code.
+ */
+
+#define AVM_NATIVE_BEGIN(HOST,LENGTH) \
+    const AVMNativeHost *host = (HOST); \
+    AVMStack             s    = vm->runtime.stack; \
+    size_t               base = vm->runtime.size - (LENGTH); \
+    AVMError             err; \
+    (void)s; (void)err;
+
+#define AVM_NATIVE_COUNT() \
+    vm->icount ++
+
+/* leaves the block at P, for the interpreter to go on */
+#define AVM_NATIVE_EXIT(P) \
+    do { \
+        vm->runtime.pos = base + (P); \
+        return AVM_NO_ERROR; \
+    } while(0)
+
+/* runs the opcode at P through its parser, leaving on errors */
+#define AVM_NATIVE_CALL(P,OP) \
+    do { \
+        vm->runtime.pos = base + (P) + 1; \
+        err = host->parsers[OP](vm); \
+        if (err != AVM_NO_ERROR) \
+            return err; \
+    } while(0)
+
+#define AVM_NATIVE_OP(P,OP,FAST) \
+    do { \
+        if (!(FAST)) \
+            AVM_NATIVE_CALL(P,OP); \
+        AVM_NATIVE_COUNT(); \
+    } while(0)
+
+/* a conditional jump from P to a label of the block, taken when T */
+#define AVM_NATIVE_JUMP_IF(P,OP,T,TARGET,LABEL) \
+    do { \
+        int c = _avm_native_test(s); \
+        if (c < 0) \
+        { \
+            AVM_NATIVE_CALL(P,OP); \
+            AVM_NATIVE_COUNT(); \
+            if (vm->runtime.pos == base + (TARGET)) \
+                goto LABEL; \
+        } \
+        else \
+        { \
+            AVM_NATIVE_COUNT(); \
+            if (c == (T)) \
+                goto LABEL; \
+        } \
+    } while(0)
+
+/* loops the frame from the start of the block, or leaves it at its end */
+#define AVM_NATIVE_END(LENGTH,LABEL) \
+    do { \
+        if (host->again(vm, delta + base)) \
+            goto LABEL; \
+        AVM_NATIVE_EXIT(LENGTH); \
+    } while(0)
+
+#endif /* AVM_NATIVE_H_INCLUDED */
@@ -5,14 +5,34 @@
 #include <string.h>
 
 
-static AVMString _create_buffer_type(AVMType t, const char *data, uint32_t size)
+#define POOL_ALLOC_OPAQUE_STRUCT_WITH_EXTRA(POOL,TYPE,EXTRA) \
+    ((TYPE)avm_pool_alloc((POOL),(EXTRA)+sizeof(struct _##TYPE)))
+
+#define POOL_ALLOC_OPAQUE_STRUCT(POOL,TYPE) \
+    POOL_ALLOC_OPAQUE_STRUCT_WITH_EXTRA(POOL,TYPE,0)
+
+/* strings, code and bytes: shared, counting refs */
+static int _is_buffer(AVMObject o)
+{
+    return o->type == AVMTypeString
+        || o->type == AVMTypeCode
+        || o->type == AVMTypeBytes;
+}
+
+static AVMString _create_buffer_type(AVMPool p, AVMType t, const char *data, uint32_t size)
 {
-    AVMString o = ALLOC_OPAQUE_STRUCT_WITH_EXTRA(AVMString,size);
+    AVMString o = POOL_ALLOC_OPAQUE_STRUCT_WITH_EXTRA(p,AVMString,size);
 
     if (o)
     {
-        o->type   = t;
-        o->length = size;
+        o->type    = t;
+        o->flags   = 0;
+        o->refs    = 1;
+        o->length  = size;
+        o->fill    = size;
+        o->data    = o->storage;
+        o->parent  = NULL;
+        o->decoded = NULL;
         if (size)
         {
             if (data != NULL)
@@ -25,9 +45,9 @@ static AVMString _create_buffer_type(AVMType t, const char *data, uint32_t size)
     return o;
 }
 
-AVMMark avm_create_mark()
+static AVMMark _create_mark(AVMPool p)
 {
-    AVMMark o = ALLOC_OPAQUE_STRUCT(AVMMark);
+    AVMMark o = POOL_ALLOC_OPAQUE_STRUCT(p,AVMMark);
 
     if (o != NULL)
     {
@@ -37,10 +57,9 @@ AVMMark avm_create_mark()
     return o;
 }
 
-
-AVMInteger  _avm_create_integer(int32_t value)
+static AVMInteger _create_integer(AVMPool p, int32_t value)
 {
-    AVMInteger o = ALLOC_OPAQUE_STRUCT(AVMInteger);
+    AVMInteger o = POOL_ALLOC_OPAQUE_STRUCT(p,AVMInteger);
 
     if (o != NULL)
     {
@@ -51,47 +70,101 @@ AVMInteger  _avm_create_integer(int32_t value)
     return o;
 }
 
+static AVMRef _create_ref(AVMPool p, uint32_t hash)
+{
+    AVMRef o = POOL_ALLOC_OPAQUE_STRUCT(p,AVMRef);
+
+    if (o != NULL)
+    {
+        o->type = AVMTypeRef;
+        o->ref  = hash;
+    }
+
+    return o;
+}
+
+AVMMark avm_create_mark()
+{
+    return _create_mark(NULL);
+}
+
 AVMInteger avm_create_integer(AVM vm, int32_t value)
 {
-    return avm_pool_get_integer(vm->integer_pool, value);
+    return _create_integer(AVM_VM_POOL(vm), value);
 }
 
 AVMString avm_create_cstring(const char *s)
 {
-    return _create_buffer_type(AVMTypeString,s,s?strlen(s):0);
+    return _create_buffer_type(NULL,AVMTypeString,s,s?strlen(s):0);
 }
 
 AVMString avm_create_string(const char *data, uint32_t size)
 {
-    return _create_buffer_type(AVMTypeString, data, size);
+    return _create_buffer_type(NULL, AVMTypeString, data, size);
 }
 
 AVMString avm_create_string_empty(uint32_t size)
 {
-    return _create_buffer_type(AVMTypeString, NULL, size);
+    return _create_buffer_type(NULL, AVMTypeString, NULL, size);
 }
 
 AVMCode avm_create_code(const char *ptr, uint32_t size)
 {
-    return (AVMCode) _create_buffer_type(AVMTypeCode,ptr,size);
+    return (AVMCode) _create_buffer_type(NULL,AVMTypeCode,ptr,size);
 }
 
-AVMRef avm_create_ref(uint32_t hash)
+AVMBytes avm_create_bytes(const char *data, uint32_t size)
 {
-    AVMRef o = ALLOC_OPAQUE_STRUCT(AVMRef);
+    return _create_buffer_type(NULL, AVMTypeBytes, data, size);
+}
 
-    if (o != NULL)
+AVMString _avm_create_string(AVM vm, const char *data, uint32_t size)
+{
+    return _create_buffer_type(AVM_VM_POOL(vm), AVMTypeString, data, size);
+}
+
+AVMCode _avm_create_code(AVM vm, const char *ptr, uint32_t size)
+{
+    return (AVMCode) _create_buffer_type(AVM_VM_POOL(vm),AVMTypeCode,ptr,size);
+}
+
+AVMBytes _avm_create_bytes(AVM vm, const char *data, uint32_t size)
+{
+    return _create_buffer_type(AVM_VM_POOL(vm), AVMTypeBytes, data, size);
+}
+
+AVMString _avm_create_view(AVM vm, AVMType t, AVMString parent, const char *data, uint32_t size)
+{
+    AVMString o = POOL_ALLOC_OPAQUE_STRUCT(AVM_VM_POOL(vm),AVMString);
+
+    if (parent->parent)
+        parent = parent->parent;
+
+    if (o)
     {
-        o->type = AVMTypeRef;
-        o->ref  = hash;
+        o->type    = t;
+        o->flags   = 0;
+        o->refs    = 1;
+        o->length  = size;
+        o->fill    = 0;
+        o->data    = (char*)data;
+        o->parent  = parent;
+        o->decoded = NULL;
+
+        parent->refs ++;
     }
 
     return o;
 }
 
+AVMRef avm_create_ref(uint32_t hash)
+{
+    return _create_ref(NULL, hash);
+}
+
 AVMExternal avm_create_external(AVMExternalType f)
 {
-    AVMExternal o = ALLOC_OPAQUE_STRUCT(AVMExternal);
+    AVMExternal o = POOL_ALLOC_OPAQUE_STRUCT(NULL,AVMExternal);
 
     if (o != NULL)
     {
@@ -107,19 +180,22 @@ void avm_object_free(AVM vm, AVMObject o)
 {
     if (o)
     {
-        AVMPool pool = NULL;
+        AVMString parent = NULL;
 
-        if (vm)
+        if (_is_buffer(o))
         {
-            switch(o->type)
-            {
-                case AVMTypeInteger:
-                    pool = vm->integer_pool;
-                    break;
-            }
+            if (--((AVMString)o)->refs > 0)
+                return;
+
+            parent = ((AVMString)o)->parent;
+
+            _avm_decoded_free(((AVMString)o)->decoded);
         }
 
-        avm_pool_release(pool, o);
+        avm_pool_release(AVM_VM_POOL(vm), o, _avm_object_raw_size(o));
+
+        if (parent)
+            avm_object_free(vm, (AVMObject)parent);
     }
 }
 
@@ -159,10 +235,10 @@ size_t _avm_object_raw_size(AVMObject o)
             return sizeof(struct _AVMInteger);
 
         case AVMTypeString:
-            return sizeof(struct _AVMString) + ((AVMString)o)->length;
-
         case AVMTypeCode:
-            return sizeof(struct _AVMString) + ((AVMCode)o)->length;
+        case AVMTypeBytes:
+            return sizeof(struct _AVMString)
+                 + (((AVMString)o)->parent? 0 : ((AVMString)o)->fill);
 
         case AVMTypeRef:
             return sizeof(struct _AVMRef);
@@ -176,13 +252,24 @@ size_t _avm_object_raw_size(AVMObject o)
 }
 
 AVMObject avm_object_copy(AVMObject o)
+{
+    return _avm_object_copy(NULL, o);
+}
+
+AVMObject _avm_object_copy(AVM vm, AVMObject o)
 {
     AVMObject copy = NULL;
     size_t s;
+
+    if (o && _is_buffer(o))
+    {
+        ((AVMString)o)->refs ++;
+        return o;
+    }
     
     if (o && (s=_avm_object_raw_size(o)) )
     {   
-        copy = malloc(s);
+        copy = avm_pool_alloc(AVM_VM_POOL(vm), s);
 
         if (copy)
         {
@@ -193,4 +280,189 @@ AVMObject avm_object_copy(AVMObject o)
     return copy;
 }
 
+AVMString _avm_string_unshare(AVM vm, AVMString s)
+{
+    if (s->refs == 1 && !s->parent)
+        return s;
+
+    AVMString copy = _create_buffer_type(AVM_VM_POOL(vm), s->type, s->data, s->length);
+
+    avm_object_free(vm, (AVMObject)s);
+    return copy;
+}
+
+AVMString _avm_string_append(AVM vm, AVMString s, const char *data, uint32_t size)
+{
+    if (size > UINT32_MAX - s->length)
+    {
+        avm_object_free(vm, (AVMObject)s);
+        return NULL;
+    }
+
+    if (s->refs > 1 || s->parent)
+    {
+        AVMString root = s->parent? s->parent : s;
+        size_t    raw  = _avm_object_raw_size((AVMObject)root);
+
+        /* the end of the root's bytes, with room left in its block */
+        if (root->type == s->type
+         && s->data + s->length == root->storage + root->fill
+         && raw + size <= avm_pool_block_size(raw))
+        {
+            if (size)
+                memcpy(&root->storage[root->fill], data, size);
+            root->fill += size;
+
+            if (s->refs == 1)
+            {
+                s->length += size;
+                return s;
+            }
 
+            AVMString view = _avm_create_view(vm, s->type, root, s->data, s->length + size);
+
+            avm_object_free(vm, (AVMObject)s);
+            return view;
+        }
+
+        AVMString r = _create_buffer_type(AVM_VM_POOL(vm), s->type, NULL, s->length + size);
+
+        if (r)
+        {
+            if (s->length)
+                memcpy(r->data, s->data, s->length);
+            if (size)
+                memcpy(&r->data[s->length], data, size);
+        }
+
+        avm_object_free(vm, (AVMObject)s);
+        return r;
+    }
+
+    size_t raw  = _avm_object_raw_size((AVMObject)s),
+           need = sizeof(struct _AVMString) + s->length + size;
+    AVMString r = avm_pool_grow(s, raw, need > raw? need : raw);
+
+    if (r == NULL)
+    {
+        avm_object_free(vm, (AVMObject)s);
+        return NULL;
+    }
+
+    r->data = r->storage;
+
+    if (size)
+        memcpy(&r->data[r->length], data, size);
+    r->length += size;
+
+    if (r->fill < r->length)
+        r->fill = r->length;
+    return r;
+}
+
+AVMString _avm_string_retype(AVM vm, AVMString s, AVMType t)
+{
+    if (s->refs == 1 && !s->parent)
+    {
+        s->type = t;
+        return s;
+    }
+
+    AVMString view = _avm_create_view(vm, t, s, s->data, s->length);
+
+    avm_object_free(vm, (AVMObject)s);
+    return view;
+}
+
+/*
+ * In place when s is a view nobody else holds, or when only its end goes;
+ * a new view otherwise, unless it would be all that keeps alive a parent
+ * many times its size: then the bytes are copied out and the parent goes.
+ */
+AVMString _avm_string_trim(AVM vm, AVMString s, uint32_t at, uint32_t n)
+{
+    AVMString root = s->parent? s->parent : s;
+
+    if (at == 0 && n == s->length)
+        return s;
+
+    if (s->refs == 1 && root->refs == 1 && n < root->fill / AVM_VIEW_PIN_RATIO)
+    {
+        AVMString copy = _create_buffer_type(AVM_VM_POOL(vm), s->type, s->data + at, n);
+
+        avm_object_free(vm, (AVMObject)s);
+        return copy;
+    }
+
+    if (s->refs == 1 && (s->parent || at == 0))
+    {
+        s->data   += at;
+        s->length  = n;
+        return s;
+    }
+
+    AVMString view = _avm_create_view(vm, s->type, s, s->data + at, n);
+
+    avm_object_free(vm, (AVMObject)s);
+    return view;
+}
+
+AVMObject _avm_value_box(AVM vm, AVMValue v)
+{
+    switch (AVM_VALUE_TAG(v))
+    {
+        case AVM_VALUE_TAG_INTEGER:
+            return (AVMObject) _create_integer(AVM_VM_POOL(vm), AVM_VALUE_INTEGER(v));
+
+        case AVM_VALUE_TAG_REF:
+            return (AVMObject) _create_ref(AVM_VM_POOL(vm), AVM_VALUE_REF(v));
+
+        case AVM_VALUE_TAG_MARK:
+            return (AVMObject) _create_mark(AVM_VM_POOL(vm));
+
+        default:
+            return AVM_VALUE_OBJECT(v);
+    }
+}
+
+AVMValue _avm_value_copy_object(AVM vm, AVMObject o)
+{
+    if (!o)
+        return AVM_VALUE_NULL;
+
+    switch ((AVMType)o->type)
+    {
+        case AVMTypeInteger:
+            return AVM_VALUE_FROM_INTEGER(((AVMInteger)o)->value);
+
+        case AVMTypeRef:
+            return AVM_VALUE_FROM_REF(((AVMRef)o)->ref);
+
+        case AVMTypeMark:
+            return AVM_VALUE_MARK;
+
+        default:
+            return AVM_VALUE_FROM_OBJECT(_avm_object_copy(vm,o));
+    }
+}
+
+AVMValue _avm_value_unbox(AVM vm, AVMObject o)
+{
+    if (!o)
+        return AVM_VALUE_NULL;
+
+    switch ((AVMType)o->type)
+    {
+        case AVMTypeInteger:
+        case AVMTypeRef:
+        case AVMTypeMark:
+        {
+            AVMValue v = _avm_value_copy_object(vm,o);
+            avm_object_free(vm, o);
+            return v;
+        }
+
+        default:
+            return AVM_VALUE_FROM_OBJECT(o);
+    }
+}
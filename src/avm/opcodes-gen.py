@@ -1,5 +1,27 @@
 #/usr/bin/python
 
+import re
+
+# operand kind (without width) -> AVMOperandKind
+OPERAND_KINDS = {
+    'hash' : 'AVMOperandValue',
+    'i'    : 'AVMOperandInteger',
+    'blob' : 'AVMOperandBlob',
+    'code' : 'AVMOperandCode',
+    'rel'  : 'AVMOperandJump',
+    'len'  : 'AVMOperandLoop',
+    'slot' : 'AVMOperandSlot',
+}
+
+MAX_SUPER_LENGTH = 8
+
+def operand_kind(operand):
+    return OPERAND_KINDS[re.sub('[0-9]+$', '', operand)]
+
+def operand_bits(operand):
+    m = re.search('([0-9]+)$', operand)
+    return int(m.group(1)) if m else 32
+
 class Generator:
     def __init__(self):
         self._lines = []
@@ -12,6 +34,12 @@ class Generator:
                 self._lines.append(l + '\n')
     
 
+    def onSuper(self, hexcode, name, components, flags):
+        pass
+
+    def onQuick(self, name, base, guard):
+        pass
+
     def finish(self):
         self.terminate()
         
@@ -21,7 +49,7 @@ class Generator:
         f.writelines(self._lines)
         f.close()
 
-        print "Generated file {0}".format(name)
+        print("Generated file {0}".format(name))
 
 class OpcodesHeaderGenerator(Generator):
 
@@ -37,7 +65,7 @@ class OpcodesHeaderGenerator(Generator):
                   'typedef enum',
                   '{'])
         
-    def onOpcode(self, hexcode, name, opcodes):
+    def onOpcode(self, hexcode, name, opcodes, operands, flags, effect):
         if name is not None:
             self.add('AVMOpcode{0:16s} = {1},'.format(name, hexcode))
     
@@ -63,7 +91,7 @@ class ParserDeclarationGenerator(Generator):
                   '/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */',
                   ''])
         
-    def onOpcode(self, hexcode, name, opcodes):
+    def onOpcode(self, hexcode, name, opcodes, operands, flags, effect):
         if name is not None:
             self.add('static AVMError _parse_{0}(AVM vm);'.format(name))
     
@@ -90,7 +118,7 @@ class ParserTableGenerator(Generator):
                   'AVMError ( *PARSER_TABLE[256] )(AVM) = {'
                   ])
         
-    def onOpcode(self, hexcode, name, opcodes):
+    def onOpcode(self, hexcode, name, opcodes, operands, flags, effect):
         if name is not None:
             self.add('    _parse_{0},'.format(name))
         else:
@@ -104,6 +132,184 @@ class ParserTableGenerator(Generator):
     def destination(self):
         return 'generated/parser-table.h'
 
+class DispatchTableGenerator(Generator):
+
+    def __init__(self):
+
+        Generator.__init__(self)
+
+        self._decoded  = []
+        self._verified = []
+        self._index    = {} # name -> position in the tables
+
+        self.add(['/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */',
+                  '',
+                  '/* included inside the threaded dispatch loop */',
+                  '',
+                  'static const void *DISPATCH_TABLE[256] = {'
+                  ])
+
+    def onOpcode(self, hexcode, name, opcodes, operands, flags, effect):
+        if name is not None:
+            self._index[name] = len(self._decoded)
+            self.add('    &&_op_{0},'.format(name))
+            self._decoded.append('    &&{0}{1},'.format(
+                                     '_dop_' if operands else '_op_', name))
+            self._verified.append('    &&{0}{1},'.format(
+                                     '_vop_' if operands else '_op_', name))
+        else:
+            self.add('    &&_op_invalid_opcode,')
+            self._decoded.append('    &&_op_invalid_opcode,')
+            self._verified.append('    &&_op_invalid_opcode,')
+
+    def onQuick(self, name, base, guard):
+        i = self._index[base]
+        self._decoded[i]  = '    &&_qop_{0},'.format(base)
+        self._verified[i] = '    &&_qop_{0},'.format(base)
+
+    def terminate(self):
+        self.add('};')
+        self.add(['',
+                  '/* handlers of decoded instructions */',
+                  'static const void *DECODED_TABLE[256] = {'])
+        self.add(self._decoded)
+        self.add('};')
+        self.add(['',
+                  '/* decoded instructions of verified code skip bounds checks */',
+                  'static const void *VERIFIED_TABLE[256] = {'])
+        self.add(self._verified)
+        self.add('};')
+
+    def destination(self):
+        return 'generated/dispatch-table.h'
+
+class DispatchLabelsGenerator(Generator):
+
+    def __init__(self):
+
+        Generator.__init__(self)
+
+        self.add(['/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */',
+                  '',
+                  '/* included inside the threaded dispatch loop */',
+                  ''])
+
+        self._quick = {} # opcode -> [(quickened form, guard)]
+
+    def onOpcode(self, hexcode, name, opcodes, operands, flags, effect):
+        if name is not None:
+            if 'ctl' in flags:
+                self.add('AVM_THREADED_CONTROL_OP({0})'.format(name))
+            elif operands:
+                self.add('AVM_THREADED_OPERAND_OP({0})'.format(name))
+            else:
+                self.add('AVM_THREADED_OP({0})'.format(name))
+
+            if operands:
+                kind = 'CONTROL' if 'ctl' in flags else 'OPERAND'
+                self.add('AVM_DECODED_{0}_OP({1},{2})'.format(
+                             kind, name, operand_bits(operands[0])))
+
+    def onQuick(self, name, base, guard):
+        self._quick.setdefault(base, []).append((name, guard))
+
+    def terminate(self):
+        self.add('AVM_THREADED_OP(invalid_opcode)')
+
+        for base, forms in self._quick.items():
+            self.add(['',
+                      'AVM_QUICKENING_BEGIN({0})'.format(base)])
+            for name, guard in forms:
+                self.add('AVM_QUICKENING_TRY({0},{1})'.format(name, guard))
+            self.add('AVM_QUICKENING_END({0})'.format(base))
+            for name, guard in forms:
+                self.add('AVM_QUICK_OP({0},{1},{2})'.format(name, base, guard))
+
+    def destination(self):
+        return 'generated/dispatch-labels.h'
+
+class SuperinstructionGenerator(Generator):
+
+    def __init__(self):
+
+        Generator.__init__(self)
+
+        self.add(['/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */',
+                  '',
+                  '/*',
+                  ' * Superinstructions run their opcodes in a row. Those marked +fast',
+                  ' * have a handler of their own that falls back to _chain_X.',
+                  ' */',
+                  ''])
+
+    def onOpcode(self, hexcode, name, opcodes, operands, flags, effect):
+        pass
+
+    def onSuper(self, hexcode, name, components, flags):
+        self.add(['/* {0} */'.format(' '.join(components)),
+                  'static AVMError _chain_{0}(AVM vm)'.format(name),
+                  '{',
+                  '    AVMError err;',
+                  ''])
+        for c in components[:-1]:
+            self.add('    if ((err = _parse_{0}(vm)) != AVM_NO_ERROR) return err;'.format(c))
+        self.add(['',
+                  '    return _parse_{0}(vm);'.format(components[-1]),
+                  '}',
+                  ''])
+
+        if 'fast' not in flags:
+            self.add(['static AVMError _parse_{0}(AVM vm)'.format(name),
+                      '{',
+                      '    return _chain_{0}(vm);'.format(name),
+                      '}',
+                      ''])
+
+    def terminate(self):
+        pass
+
+    def destination(self):
+        return 'generated/superinstructions.h'
+
+class SuperinstructionTableGenerator(Generator):
+
+    def __init__(self):
+
+        Generator.__init__(self)
+
+        self.add(['#ifndef SUPERINSTRUCTION_TABLE_H_INCLUDED',
+                  '#define SUPERINSTRUCTION_TABLE_H_INCLUDED',
+                  '',
+                  '/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */',
+                  '',
+                  '#define SUPERINSTRUCTION_MAX_LENGTH {0}'.format(MAX_SUPER_LENGTH),
+                  '',
+                  'static struct {',
+                  '    const char *name;',
+                  '    AVMOpcode   op;',
+                  '    int         length;',
+                  '    AVMOpcode   ops[SUPERINSTRUCTION_MAX_LENGTH];',
+                  '}',
+                  'SUPERINSTRUCTION_TABLE[] = {'
+                  ])
+
+    def onOpcode(self, hexcode, name, opcodes, operands, flags, effect):
+        pass
+
+    def onSuper(self, hexcode, name, components, flags):
+        self.add('    {{"{0}", AVMOpcode{0}, {1}, {{{2}}}}},'.format(
+                     name, len(components),
+                     ', '.join('AVMOpcode' + c for c in components)))
+
+    def terminate(self):
+        self.add(['    {NULL, 0, 0, {0}}',
+                  '};',
+                  '',
+                  '#endif // SUPERINSTRUCTION_TABLE_H_INCLUDED'])
+
+    def destination(self):
+        return 'generated/superinstruction-table.h'
+
 class OpcodeNameTableGenerator(Generator):
 
     def __init__(self):
@@ -122,7 +328,7 @@ class OpcodeNameTableGenerator(Generator):
                   'OPCODE_TABLE[] = {'
                   ])
         
-    def onOpcode(self, hexcode, name, opcodes):
+    def onOpcode(self, hexcode, name, opcodes, operands, flags, effect):
         if name is not None:
             for op in opcodes:
                 self.add('    {'+'"{0}", AVMOpcode{1}'.format(op,name)+'},')
@@ -137,15 +343,75 @@ class OpcodeNameTableGenerator(Generator):
         return 'generated/opcode-name-table.h'
 
 
+class OpcodeInfoGenerator(Generator):
+
+    def __init__(self):
+
+        Generator.__init__(self)
+
+        self.add(['#ifndef OPCODE_INFO_H_INCLUDED',
+                  '#define OPCODE_INFO_H_INCLUDED',
+                  '',
+                  '/* THIS FILE IS AUTOGENERATED: DO NOT EDIT */',
+                  '',
+                  'static const AVMOpcodeInfo OPCODE_INFO[256] = {'
+                  ])
+
+    def onOpcode(self, hexcode, name, opcodes, operands, flags, effect):
+        if name is None:
+            self.add('    {0, 0, 0, 0, AVMOperandNone, 0},')
+            return
+
+        bytes = 0
+        kind  = 'AVMOperandNone'
+
+        if operands:
+            bytes = operand_bits(operands[0]) // 8
+            kind  = operand_kind(operands[0])
+
+        pops, pushes = effect if effect else (-1, -1)
+
+        self.add('    {{1, {0}, {1}, {2}, {3}, {4}}}, /* {5} */'.format(
+                     pops, pushes, bytes, kind, int('ctl' in flags), name))
+
+    def terminate(self):
+        self.add(['};',
+                  '',
+                  '#endif // OPCODE_INFO_H_INCLUDED'])
+
+    def destination(self):
+        return 'generated/opcode-info.h'
+
+
 generators = []
 generators.append( OpcodesHeaderGenerator() )
 generators.append( ParserDeclarationGenerator() )
 generators.append( ParserTableGenerator() )
 generators.append( OpcodeNameTableGenerator() )
+generators.append( DispatchTableGenerator() )
+generators.append( DispatchLabelsGenerator() )
+generators.append( OpcodeInfoGenerator() )
+generators.append( SuperinstructionGenerator() )
+generators.append( SuperinstructionTableGenerator() )
 
 f = open('opcodes.list', 'r')
 
-lines = f.readlines(300) # not really big, aprox 256
+lines = f.readlines() # not really big, aprox 256
+
+defined = {} # name -> (operands, flags, effect)
+
+def super_effect(components):
+    need = depth = 0
+
+    for c in components:
+        effect = defined[c][2]
+        if effect is None:
+            return None
+
+        need   = max(need, effect[0] - depth)
+        depth += effect[1] - effect[0]
+
+    return (need, need + depth)
 
 for line in lines:
     cmt = line.find('#')
@@ -157,14 +423,71 @@ for line in lines:
 
     nparts = len(parts)
 
+    if nparts == 0:
+        continue
+
+    # 0xNN Name [mnemonic ...] [:operand ...] [+flag ...] [%pops/pushes]
+    #
+    # flags:
+    #   +ctl  pushes or pops execution frames
+    #
+    # the stack effect is given only when it doesn't depend on the values
+    # involved; pushes is a lower bound.
+
+    # 0xNN Name = Opcode Opcode ... [+fast]
+    #
+    # a superinstruction: the named opcodes, without operands, in a row.
+    # +fast when run.c gives it a handler of its own.
+
+    # ~ Name Opcode Guard
+    #
+    # a quickened form of Opcode, for decoded instructions only: they
+    # switch to it on their first run while the operands pass Guard.
+
+    if parts[0] == '~':
+        if nparts != 4 or parts[2] not in defined or defined[parts[2]][0]:
+            raise Exception('{0}: bad quickened form'.format(line))
+
+        for g in generators:
+            g.onQuick(parts[1], parts[2], parts[3])
+        continue
+
+    if nparts > 2 and parts[2] == '=':
+        hexcode, defcode = parts[0], parts[1]
+        components = [p for p in parts[3:] if p[0] != '+']
+        flags      = [p[1:] for p in parts[3:] if p[0] == '+']
+
+        for c in components:
+            if c not in defined or defined[c][0] or 'ctl' in defined[c][1]:
+                raise Exception('{0}: {1} cannot be part of a '
+                                'superinstruction'.format(defcode, c))
+
+        if not 2 <= len(components) <= MAX_SUPER_LENGTH:
+            raise Exception('{0}: bad length'.format(defcode))
+
+        defined[defcode] = ([], flags, super_effect(components))
+
+        for g in generators:
+            g.onOpcode(hexcode,defcode,[],[],flags,defined[defcode][2])
+            g.onSuper(hexcode,defcode,components,flags)
+        continue
+
     hexcode = parts[0]
     defcode = parts[1] if nparts>1 else None
-    opcodes = parts[2:]
+    opcodes  = [p for p in parts[2:] if p[0] not in ':+%']
+    operands = [p[1:] for p in parts[2:] if p.startswith(':')]
+    flags    = [p[1:] for p in parts[2:] if p.startswith('+')]
+    effect   = [tuple(int(n) for n in p[1:].split('/'))
+                for p in parts[2:] if p.startswith('%')]
+    effect   = effect[0] if effect else None
+
+    if defcode is not None:
+        defined[defcode] = (operands, flags, effect)
 
 #print 'Found opcode {0} def {1} opcodes{2}'.format(hexcode,defcode,opcodes)
 
     for g in generators:
-        g.onOpcode(hexcode,defcode,opcodes)
+        g.onOpcode(hexcode,defcode,opcodes,operands,flags,effect)
 
 
 for g in generators:
@@ -0,0 +1,152 @@
+#include "avm/internals.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Per-VM free lists, one per power of two size class from 16 bytes up to
+ * the configured maximum block size.
+ *
+ * Every block up to AVM_POOL_MAX_BLOCK_EXP is allocated rounded up to its
+ * class, pooled or not. Any pool can therefore cache any object on release,
+ * and objects that escape to the host can still be handed to free().
+ *
+ * Larger blocks are malloc'd rounded up to a quarter of their power of two,
+ * so that a string appended to in place still grows geometrically.
+ */
+
+static uint32_t _pool_class(size_t size)
+{
+    if (size <= AVM_POOL_CLASS_SIZE(0))
+        return 0;
+
+#if defined(__GNUC__)
+    return (32 - __builtin_clz((uint32_t)size - 1)) - AVM_POOL_MIN_BLOCK_EXP;
+#else
+    uint32_t c = 0;
+    while (AVM_POOL_CLASS_SIZE(c) < size)
+        ++c;
+    return c;
+#endif
+}
+
+static size_t _large_size(size_t size)
+{
+#if defined(__GNUC__)
+    size_t step = ((size_t)1 << (63 - __builtin_clzll((unsigned long long)size))) >> 2;
+#else
+    size_t step = 1;
+    while (step <= size >> 3)
+        step <<= 1;
+#endif
+    return (size + step - 1) & ~(step - 1);
+}
+
+AVMPool avm_pool_init(uint32_t blocks, uint32_t max_size)
+{
+    AVMPool p = ALLOC_OPAQUE_STRUCT(AVMPool);
+
+    if (p != NULL)
+    {
+        memset(p, 0, sizeof(*p));
+
+        if (max_size > AVM_POOL_CLASS_SIZE(AVM_POOL_MAX_CLASSES-1))
+            max_size = AVM_POOL_CLASS_SIZE(AVM_POOL_MAX_CLASSES-1);
+
+        p->max_size = max_size;
+        p->nclasses = max_size? _pool_class(max_size) + 1 : 0;
+
+        uint32_t i;
+        for (i=0;i<p->nclasses;++i)
+        {
+            p->c[i].max = blocks;
+        }
+    }
+
+    return p;
+}
+
+void avm_pool_free(AVMPool p)
+{
+    if (p != NULL)
+    {
+        uint32_t i;
+        for (i=0;i<p->nclasses;++i)
+        {
+            void *b = p->c[i].head;
+
+            while (b)
+            {
+                void *next = *(void**)b;
+                free(b);
+                b = next;
+            }
+        }
+
+        free(p);
+    }
+}
+
+void* avm_pool_alloc(AVMPool p, size_t size)
+{
+    if (size > AVM_POOL_CLASS_SIZE(AVM_POOL_MAX_CLASSES-1))
+    {
+        return malloc(_large_size(size));
+    }
+
+    uint32_t c = _pool_class(size);
+
+    if (p != NULL && c < p->nclasses)
+    {
+        struct _AVMPoolClass *pc = &p->c[c];
+
+        if (pc->head)
+        {
+            void *b  = pc->head;
+            pc->head = *(void**)b;
+            pc->cached --;
+            pc->hits ++;
+            return b;
+        }
+
+        pc->misses ++;
+    }
+
+    return malloc(AVM_POOL_CLASS_SIZE(c));
+}
+
+/* usable size of a block allocated for size bytes */
+size_t avm_pool_block_size(size_t size)
+{
+    if (size > AVM_POOL_CLASS_SIZE(AVM_POOL_MAX_CLASSES-1))
+        return _large_size(size);
+
+    return AVM_POOL_CLASS_SIZE(_pool_class(size));
+}
+
+/* grows a block holding size bytes in place when its class has room */
+void* avm_pool_grow(void *ptr, size_t size, size_t new_size)
+{
+    if (new_size <= avm_pool_block_size(size))
+        return ptr;
+
+    return realloc(ptr, avm_pool_block_size(new_size));
+}
+
+void avm_pool_release(AVMPool p, void *ptr, size_t size)
+{
+    if (p != NULL && size <= p->max_size)
+    {
+        struct _AVMPoolClass *pc = &p->c[_pool_class(size)];
+
+        if (pc->cached < pc->max)
+        {
+            *(void**)ptr = pc->head;
+            pc->head     = ptr;
+            pc->cached ++;
+            return;
+        }
+    }
+
+    free(ptr);
+}
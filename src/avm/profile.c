@@ -0,0 +1,177 @@
+#include "avm/internals.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Opcode n-grams, for picking superinstructions. The opcodes run in a row
+ * are shifted into history, a byte each, and every n-gram ending at the
+ * latest one is counted in an open addressing table keyed by its bytes
+ * and length. Operands, jumps and frame changes break the row.
+ */
+
+#define NGRAM_KEY(HISTORY,LEN) \
+    (((HISTORY) & ((1ull << 8*(LEN)) - 1)) | ((uint64_t)(LEN) << 56))
+
+struct _AVMNgram
+{
+    uint64_t key; /* 0 when free */
+    uint32_t count;
+};
+
+struct _AVMProfile
+{
+    uint8_t   n,      /* longest n-gram counted */
+              length; /* opcodes in history */
+    uint64_t  history;
+    uint32_t  size,
+              count;
+    struct _AVMNgram *table;
+};
+
+static struct _AVMNgram* _ngram_find(struct _AVMNgram *table, uint32_t mask, uint64_t key)
+{
+    uint32_t i = (uint32_t)((key * 0x9e3779b97f4a7c15ull) >> 32) & mask;
+
+    while (table[i].key && table[i].key != key)
+    {
+        i = (i + 1) & mask;
+    }
+
+    return &table[i];
+}
+
+static char _ngram_grow(AVMProfile p)
+{
+    uint32_t          size  = p->size? p->size * 2 : 1024,
+                      i;
+    struct _AVMNgram *table = calloc(size, sizeof(*table));
+
+    if (table == NULL)
+        return 0;
+
+    for (i=0;i<p->size;++i)
+    {
+        if (p->table[i].key)
+            *_ngram_find(table, size-1, p->table[i].key) = p->table[i];
+    }
+
+    free(p->table);
+
+    p->table = table;
+    p->size  = size;
+
+    return 1;
+}
+
+void _avm_profile_op(AVMProfile p, uint8_t op)
+{
+    uint32_t len;
+
+    p->history = (p->history << 8) | op;
+
+    if (p->length < p->n)
+        p->length ++;
+
+    for (len=2;len<=p->length;++len)
+    {
+        uint64_t key = NGRAM_KEY(p->history, len);
+
+        /* counts are lost rather than failing the run */
+        if (p->count + 1 > p->size - p->size/4 && !_ngram_grow(p))
+            return;
+
+        struct _AVMNgram *e = _ngram_find(p->table, p->size-1, key);
+
+        if (!e->key)
+        {
+            e->key = key;
+            p->count ++;
+        }
+
+        e->count ++;
+    }
+}
+
+void _avm_profile_break(AVMProfile p)
+{
+    p->length = 0;
+}
+
+void _avm_profile_free(AVMProfile p)
+{
+    if (p)
+    {
+        free(p->table);
+        free(p);
+    }
+}
+
+AVMError avm_profile(AVM vm, uint8_t n)
+{
+    _avm_profile_free(vm->profile);
+    vm->profile = NULL;
+
+    if (n == 0)
+        return AVM_NO_ERROR;
+
+    if (n < 2 || n > AVM_PROFILE_MAX_NGRAM)
+        return AVM_ERROR_INVALID_ARG;
+
+    AVMProfile p = ALLOC_OPAQUE_STRUCT(AVMProfile);
+
+    if (p == NULL)
+        return AVM_ERROR_NO_MEM;
+
+    memset(p, 0, sizeof(*p));
+    p->n = n;
+
+    vm->profile = p;
+
+    return AVM_NO_ERROR;
+}
+
+static int _ngram_cmp(const void *a, const void *b)
+{
+    uint32_t ca = ((const struct _AVMNgram*)a)->count,
+             cb = ((const struct _AVMNgram*)b)->count;
+
+    return ca < cb? 1 : ca > cb? -1 : 0;
+}
+
+uint32_t avm_stats_ngrams(AVM vm, AVMNgramStats *stats, uint32_t n)
+{
+    AVMProfile p = vm->profile;
+    uint32_t   i, j, k;
+
+    if (!p || !p->count)
+        return 0;
+
+    struct _AVMNgram *all = malloc(p->count * sizeof(*all));
+
+    if (all == NULL)
+        return 0;
+
+    for (i=0,j=0;i<p->size;++i)
+    {
+        if (p->table[i].key)
+            all[j++] = p->table[i];
+    }
+
+    qsort(all, p->count, sizeof(*all), _ngram_cmp);
+
+    for (i=0;i<n && i<p->count;++i)
+    {
+        stats[i].length = all[i].key >> 56;
+        stats[i].count  = all[i].count;
+
+        for (k=0;k<stats[i].length;++k)
+        {
+            stats[i].ops[k] = all[i].key >> 8*(stats[i].length-1-k);
+        }
+    }
+
+    free(all);
+
+    return p->count;
+}
@@ -6,6 +6,12 @@
 #include "avm/generated/opcodes.h"
 #include "avm/generated/parsers-decl.h"
 #include "avm/generated/parser-table.h"
+#include "avm/generated/opcode-info.h"
+
+/* labels-as-values dispatch, unless disabled or unsupported */
+#if defined(__GNUC__) && !defined(AVM_NO_THREADED_DISPATCH)
+#   define AVM_THREADED_DISPATCH
+#endif
 
 static AVMError _parse_invalid_opcode(AVM vm)
 {
@@ -15,9 +21,8 @@ static AVMError _parse_invalid_opcode(AVM vm)
 #define MK_NUMBER_FN(N) \
 static AVMError _parse_ ## N(AVM vm) \
 { \
-    AVMInteger o = avm_create_integer(vm,N); \
-    if (o == NULL) return AVM_ERROR_NO_MEM; \
-    return avm_stack_push(vm->runtime.stack, (AVMObject)o); \
+    return _avm_stack_push_value(vm->runtime.stack, \
+                                 AVM_VALUE_FROM_INTEGER(N)); \
 }
 
 MK_NUMBER_FN(0)
@@ -32,9 +37,8 @@ MK_NUMBER_FN(7)
 #define MK_NEG_NUMBER_FN(N) \
 static AVMError _parse_N ## N(AVM vm) \
 { \
-    AVMInteger o = avm_create_integer(vm,-N); \
-    if (o == NULL) return AVM_ERROR_NO_MEM; \
-    return avm_stack_push(vm->runtime.stack, (AVMObject)o); \
+    return _avm_stack_push_value(vm->runtime.stack, \
+                                 AVM_VALUE_FROM_INTEGER(-N)); \
 }
 
 MK_NEG_NUMBER_FN(1)
@@ -45,153 +49,78 @@ MK_NEG_NUMBER_FN(5)
 MK_NEG_NUMBER_FN(6)
 MK_NEG_NUMBER_FN(7)
 
-static AVMError _read_uint8(AVM vm, uint32_t *value)
-{
-    if (vm->runtime.pos + 1 > vm->runtime.size)
-    {
-        return AVM_ERROR_REF_TRUNCATED;
-    }
-    
-    uint8_t *p = (uint8_t*)&vm->runtime.code[vm->runtime.pos];
-
-    *value = p[0];
-    
-    vm->runtime.pos += 1;
-
-    return AVM_NO_ERROR;
-}
-
-static AVMError _read_uint16(AVM vm, uint32_t *value)
-{
-    if (vm->runtime.pos + 2 > vm->runtime.size)
-    {
-        return AVM_ERROR_REF_TRUNCATED;
-    }
-    
-    uint8_t *p = (uint8_t*)&vm->runtime.code[vm->runtime.pos];
-
-    *value = (p[0]<<8) | p[1];
-    
-    vm->runtime.pos += 2;
-    return AVM_NO_ERROR;
-}
-
-static AVMError _read_uint24(AVM vm, uint32_t *value)
-{
-    if (vm->runtime.pos + 3 > vm->runtime.size)
-    {
-        return AVM_ERROR_REF_TRUNCATED;
-    }
-    
-    uint8_t *p = (uint8_t*)&vm->runtime.code[vm->runtime.pos];
-
-    *value = p[2] | (p[1]<<8) | (p[0]<<16);
-    
-    vm->runtime.pos += 3;
-    return AVM_NO_ERROR;
-}
-
-static AVMError _read_uint32(AVM vm, uint32_t *value)
-{
-    if (vm->runtime.pos + 4 > vm->runtime.size)
-    {
-        return AVM_ERROR_REF_TRUNCATED;
-    }
-    
-    uint8_t *p = (uint8_t*)&vm->runtime.code[vm->runtime.pos];
-
-    *value = p[3] | (p[2]<<8) | (p[1]<<16) | (p[0]<<24);
-    
-    vm->runtime.pos += 4;
-    return AVM_NO_ERROR;
-}
-
-static AVMError _read_int8(AVM vm, int32_t *value)
-{
-    if (vm->runtime.pos + 1 > vm->runtime.size)
-    {
-        return AVM_ERROR_REF_TRUNCATED;
-    }
-    
-    int8_t *p = (int8_t*)&vm->runtime.code[vm->runtime.pos];
-
-    *value = p[0];
-    
-    vm->runtime.pos += 1;
-
-    return AVM_NO_ERROR;
-}
-
-static AVMError _read_int16(AVM vm, int32_t *value)
-{
-    int16_t vvalue;
-
-    if (vm->runtime.pos + 2 > vm->runtime.size)
-    {
-        return AVM_ERROR_REF_TRUNCATED;
-    }
-    
-    uint8_t *p = (uint8_t*)&vm->runtime.code[vm->runtime.pos];
+/* big endian operands, without bounds checks */
+#define AVM_DECODE_8(P)  ((uint32_t)(P)[0])
+#define AVM_DECODE_16(P) (((uint32_t)(P)[0]<<8)  | (P)[1])
+#define AVM_DECODE_24(P) (((uint32_t)(P)[0]<<16) | ((uint32_t)(P)[1]<<8) | (P)[2])
+#define AVM_DECODE_32(P) (((uint32_t)(P)[0]<<24) | ((uint32_t)(P)[1]<<16) \
+                        | ((uint32_t)(P)[2]<<8)  | (P)[3])
 
-    vvalue = (p[0]<<8) | p[1];
-    
-    vm->runtime.pos += 2;
-    
-    *value = vvalue;
-    return AVM_NO_ERROR;
+#define MK_READ_UINT_FN(BITS) \
+static AVMError _read_uint ## BITS(AVM vm, uint32_t *value) \
+{ \
+    if (vm->runtime.pos + (BITS)/8 > vm->runtime.size) \
+    { \
+        return AVM_ERROR_REF_TRUNCATED; \
+    } \
+    *value = AVM_DECODE_ ## BITS((const uint8_t*)&vm->runtime.code[vm->runtime.pos]); \
+    vm->runtime.pos += (BITS)/8; \
+    return AVM_NO_ERROR; \
+}
+
+MK_READ_UINT_FN(8)
+MK_READ_UINT_FN(16)
+MK_READ_UINT_FN(24)
+MK_READ_UINT_FN(32)
+
+/*
+ * Opcodes with operands are split in two: _parse_X decodes the operand
+ * checking it against the end of the code, _exec_X does the work. The
+ * threaded engine decodes each instruction once and calls _exec_X directly
+ * on later runs.
+ */
+#define MK_OPERAND_PARSER(NAME,BITS) \
+static AVMError _parse_ ## NAME(AVM vm) \
+{ \
+    uint32_t operand; \
+    AVMError err = _read_uint##BITS(vm,&operand); \
+    if (err != AVM_NO_ERROR) \
+        return err; \
+    return _exec_ ## NAME(vm, operand); \
 }
 
-static AVMError _read_int24(AVM vm, int32_t *value)
-{
-    uint32_t vvalue;
-    
-    if (vm->runtime.pos + 3 > vm->runtime.size)
-    {
-        return AVM_ERROR_REF_TRUNCATED;
-    }
-    
-    uint8_t *p = (uint8_t*)&vm->runtime.code[vm->runtime.pos];
-
-    vvalue = p[2] | (p[1]<<8) | (p[0]<<16);
-    
-    vm->runtime.pos += 3;
-    
-    /* sign extend to 32 bits */
-    if (vvalue & 0x800000)
-    {
-        vvalue |= 0xff000000;
-    }
-    
-    *value = vvalue;
-    return AVM_NO_ERROR;
+/* the operand is the length of data following it */
+#define MK_BLOB_PARSER(NAME,BITS,TRUNCATED) \
+static AVMError _parse_ ## NAME(AVM vm) \
+{ \
+    uint32_t operand; \
+    AVMError err = _read_uint##BITS(vm,&operand); \
+    if (err != AVM_NO_ERROR) \
+        return err; \
+    if (vm->runtime.pos + operand > vm->runtime.size) \
+        return TRUNCATED; \
+    return _exec_ ## NAME(vm, operand); \
 }
 
-static AVMError _read_int32(AVM vm, int32_t *value)
+static inline int32_t _sign_extend(uint32_t value, int bits)
 {
-    if (vm->runtime.pos + 4 > vm->runtime.size)
-    {
-        return AVM_ERROR_REF_TRUNCATED;
-    }
-    
-    uint8_t *p = (uint8_t*)&vm->runtime.code[vm->runtime.pos];
-
-    *value = p[3] | (p[2]<<8) | (p[1]<<16) | (p[0]<<24);
-    
-    vm->runtime.pos += 4;
-    return AVM_NO_ERROR;
+    return (int32_t)(value << (32-bits)) >> (32-bits);
 }
 
+/* decoded instructions carry the operand already sign extended */
 #define MK_NUMBER_BITS_FN(BITS) \
+static AVMError _exec_Int ## BITS(AVM vm, uint32_t value) \
+{ \
+    return _avm_stack_push_value(vm->runtime.stack, \
+                AVM_VALUE_FROM_INTEGER((int32_t)value)); \
+} \
 static AVMError _parse_Int ## BITS(AVM vm) \
 { \
-    int32_t value; \
-    AVMError err = _read_int##BITS(vm, &value); \
+    uint32_t operand; \
+    AVMError err = _read_uint##BITS(vm,&operand); \
     if (err != AVM_NO_ERROR) \
         return err; \
-    AVMInteger o = avm_create_integer(vm,value); \
-    if (o == NULL) \
-        return AVM_ERROR_NO_MEM; \
-    return avm_stack_push(vm->runtime.stack, (AVMObject)o); \
+    return _exec_Int ## BITS(vm, _sign_extend(operand,BITS)); \
 }
 
 MK_NUMBER_BITS_FN(8)
@@ -199,40 +128,18 @@ MK_NUMBER_BITS_FN(16)
 MK_NUMBER_BITS_FN(24)
 MK_NUMBER_BITS_FN(32)
 
-static AVMError _parse_Ref(AVM vm)
+static AVMError _exec_Ref(AVM vm, uint32_t hash)
 {
-    uint32_t value;
-    
-    if (vm->runtime.pos + 4 > vm->runtime.size)
-    {
-        return AVM_ERROR_REF_TRUNCATED;
-    }
-    
-    uint8_t *p = (uint8_t*)&vm->runtime.code[vm->runtime.pos];
-
-    value = (p[0]<<24)
-          | (p[1]<<16)
-          | (p[2]<<8)
-          | (p[3]);
-    
-    vm->runtime.pos += 4;
-    
-    AVMRef o = avm_create_ref(value);
-
-    if (o == NULL)
-    {
-        return AVM_ERROR_NO_MEM;
-    }
-    
-    return avm_stack_push(vm->runtime.stack, (AVMObject)o);
+    return _avm_stack_push_value(vm->runtime.stack, AVM_VALUE_FROM_REF(hash));
 }
 
+MK_OPERAND_PARSER(Ref, 32)
+
 static AVMError _parse_Count(AVM vm)
 {
-    AVMStack s   = vm->runtime.stack;
-    AVMInteger i = avm_create_integer(vm,s->used);
+    AVMStack s = vm->runtime.stack;
 
-    return i!=NULL? avm_stack_push(s,(AVMObject)i) : AVM_ERROR_NO_MEM;
+    return _avm_stack_push_value(s, AVM_VALUE_FROM_INTEGER(s->used));
 }
 
 static AVMError _parse_Index(AVM vm)
@@ -244,23 +151,21 @@ static AVMError _parse_Index(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject opos = avm_stack_at(s,0);
-    
-    if (opos->type  != AVMTypeInteger)
+    AVMValue opos = _avm_stack_value_at(s,0);
+
+    if (!AVM_VALUE_IS_INTEGER(opos))
         return AVM_ERROR_WRONG_TYPE;
- 
+
     avm_stack_discard(s, 1);
-    
-    AVMObject obj = avm_stack_at(s,((AVMInteger)opos)->value);
 
-    avm_object_free(vm,opos);
+    AVMValue obj = _avm_stack_value_at(s,AVM_VALUE_INTEGER(opos));
 
-    if (obj == NULL)
+    if (obj == AVM_VALUE_NULL)
         return AVM_ERROR_STACK_RANGE;
 
-    AVMObject oo = avm_object_copy(obj);
-    return oo? avm_stack_push(s,oo) : AVM_ERROR_NO_MEM;
-        
+    AVMValue oo = _avm_value_copy(vm,obj);
+    return oo? _avm_stack_push_value(s,oo) : AVM_ERROR_NO_MEM;
+
 }
 
 static AVMError _parse_Copy(AVM vm)
@@ -272,31 +177,19 @@ static AVMError _parse_Copy(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject on = avm_stack_at(s,0);
-    
-    if (on->type  != AVMTypeInteger)
+    AVMValue on = _avm_stack_value_at(s,0);
+
+    if (!AVM_VALUE_IS_INTEGER(on))
         return AVM_ERROR_WRONG_TYPE;
- 
-    int32_t n = ((AVMInteger)on)->value;
-    
+
+    int32_t n = AVM_VALUE_INTEGER(on);
+
     avm_stack_discard(s, 1);
-    avm_object_free(vm,on);
-    
+
     if (avm_stack_size(s) < n)
         return AVM_ERROR_STACK_RANGE;
 
-    int32_t i;
-    AVMError err;
-
-    for (i=n-1,err=AVM_NO_ERROR;err==AVM_NO_ERROR && n>0;n--)
-    {
-        AVMObject o   = avm_stack_at(s, i),
-                  oo  = avm_object_copy(o);
-        
-        err = oo!=NULL? avm_stack_push(s, oo) : AVM_ERROR_NO_MEM;
-    }
-
-    return err;
+    return _avm_stack_copy(vm, s, n);
 }
 
 static AVMError _parse_Roll(AVM vm)
@@ -308,45 +201,25 @@ static AVMError _parse_Roll(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject od = avm_stack_at(s,0),
-              on = avm_stack_at(s,1);
-    
-    if (od->type  != AVMTypeInteger
-     || on->type  != AVMTypeInteger)
+    AVMValue od = _avm_stack_value_at(s,0),
+             on = _avm_stack_value_at(s,1);
+
+    if (!AVM_VALUE_IS_INTEGER(od)
+     || !AVM_VALUE_IS_INTEGER(on))
         return AVM_ERROR_WRONG_TYPE;
- 
+
     avm_stack_discard(s, 2);
-    
-    int32_t d = ((AVMInteger)od)->value,
-            n = ((AVMInteger)on)->value;
-    
-    avm_object_free(vm,od);
-    avm_object_free(vm,on);
-    
+
+    int32_t d = AVM_VALUE_INTEGER(od),
+            n = AVM_VALUE_INTEGER(on);
+
     if (n > s->used)
         return AVM_ERROR_STACK_RANGE;
-    
+
     if (d >= n || d <= -n)
         return AVM_ERROR_DELTA_RANGE;
 
-    AVMObject *list = malloc( n * sizeof(AVMObject));
-    if (!list)
-        return AVM_ERROR_NO_MEM;
-
-    int32_t i;
-    for (i=0;i<n;++i)
-    {
-        list[i] = avm_stack_at(s,i);
-    }
-
-    for (i=0;i<n;++i)
-    {
-        int32_t pos = (i+d) % n;
-        if (pos<0) pos += n;
-        _avm_stack_set(s,i,list[pos]);
-    }
-
-    free(list);
+    _avm_stack_rotate(s, n, d < 0? d + n : d);
     return AVM_NO_ERROR;
 }
 
@@ -359,100 +232,296 @@ static AVMError _parse_Rev(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject on = avm_stack_at(s,0);
-    
-    if (on->type  != AVMTypeInteger)
+    AVMValue on = _avm_stack_value_at(s,0);
+
+    if (!AVM_VALUE_IS_INTEGER(on))
         return AVM_ERROR_WRONG_TYPE;
- 
-    int32_t n = ((AVMInteger)on)->value;
-    
+
+    int32_t n = AVM_VALUE_INTEGER(on);
+
     avm_stack_discard(s, 1);
-    avm_object_free(vm,on);
-    
+
     if (avm_stack_size(s) < n)
         return AVM_ERROR_STACK_RANGE;
 
-    int32_t i, j;
+    _avm_stack_reverse(s, n);
+    return AVM_NO_ERROR;
+}
+
+/* makes vm->runtime reflect the topmost frame */
+static void _frame_load(AVM vm)
+{
+    struct _AVMFrame *f = &vm->runtime.frames[vm->runtime.depth-1];
+
+    vm->runtime.code = f->code->data;
+    vm->runtime.pos  = f->pos;
+    vm->runtime.size = f->end;
+    vm->runtime.root = f->code->parent? f->code->parent : f->code;
 
-    for (i=0,j=n-1; i < j; ++i, --j)
+    vm->runtime.verified = vm->runtime.root->flags & AVM_CODE_VERIFIED;
+}
+
+static void _frame_pop(AVM vm);
+
+/* puts back the registers of the caller that the returning call set */
+static void _regs_restore(AVM vm, uint32_t saved, uint16_t regs)
+{
+    while (vm->runtime.saved.used > saved)
     {
-        AVMObject a = avm_stack_at(s, i),
-                  b = avm_stack_at(s, j);
+        struct _AVMSavedReg *r = &vm->runtime.saved.ptr[--vm->runtime.saved.used];
 
-        _avm_stack_set(s, i, b);
-        _avm_stack_set(s, j, a);
+        _avm_value_free(vm, vm->runtime.regs[r->reg]);
+        vm->runtime.regs[r->reg] = r->value;
     }
 
-    return AVM_NO_ERROR;
+    vm->runtime.regs_set = regs;
 }
 
-static AVMError _run_subroutine(AVM vm, AVMCode code)
+/* frees the innermost window and returns to the one below it */
+static void _locals_leave(AVM vm, uint32_t base)
 {
-    const char *saved_code = vm->runtime.code;
-    size_t      saved_pos  = vm->runtime.pos,
-                saved_size = vm->runtime.size;
+    while (vm->runtime.locals.used > vm->runtime.locals.base)
+    {
+        _avm_value_free(vm, vm->runtime.locals.slots[--vm->runtime.locals.used]);
+    }
 
-    AVMError err = avm_run(vm, code->data, code->length, vm->runtime.stack);
+    vm->runtime.locals.base = base;
+}
 
-    vm->runtime.code = saved_code;
-    vm->runtime.pos  = saved_pos;
-    vm->runtime.size = saved_size;
+/* a block with nothing left to run is replaced rather than returned to */
+static char _frame_replaced(AVM vm, AVMFrameKind kind)
+{
+    return kind != AVMFrameRun
+        && vm->runtime.depth > vm->runtime.base
+        && vm->runtime.frames[vm->runtime.depth-1].kind == AVMFrameBlock
+        && vm->runtime.pos >= vm->runtime.size;
+}
 
-    return err;
+/* starts running code in a new frame; takes ownership of code */
+static struct _AVMFrame* _frame_push(AVM vm, AVMCode code, AVMFrameKind kind, AVMError *err)
+{
+    if (_frame_replaced(vm, kind))
+    {
+        _frame_pop(vm);
+    }
+
+    if (vm->runtime.depth == vm->runtime.reserved)
+    {
+        uint32_t reserved = vm->runtime.reserved
+                          ? vm->runtime.reserved * 2
+                          : AVM_FRAMES_INITIAL_RESERVE;
+
+        struct _AVMFrame *frames = NULL;
+
+        if (reserved <= AVM_FRAMES_MAX)
+        {
+            frames = realloc(vm->runtime.frames, reserved*sizeof(*frames));
+        }
+
+        if (frames == NULL)
+        {
+            *err = reserved <= AVM_FRAMES_MAX? AVM_ERROR_NO_MEM
+                                             : AVM_ERROR_CALL_DEPTH;
+            avm_object_free(vm, (AVMObject)code);
+            return NULL;
+        }
+
+        vm->runtime.frames   = frames;
+        vm->runtime.reserved = reserved;
+    }
+
+    if (vm->runtime.depth > 0)
+    {
+        vm->runtime.frames[vm->runtime.depth-1].pos = vm->runtime.pos;
+    }
+
+    struct _AVMFrame *f = &vm->runtime.frames[vm->runtime.depth++];
+
+    f->code  = code;
+    f->pos   = 0;
+    f->start = 0;
+    f->end   = code->length;
+    f->kind  = kind;
+
+    if (kind == AVMFrameCall || kind == AVMFrameRun)
+    {
+        f->saved = vm->runtime.saved.used;
+        f->regs  = vm->runtime.regs_set;
+        vm->runtime.regs_set = 0;
+    }
+
+    /* code run from an object has locals of its own, inline loops don't */
+    f->window = 1;
+    f->locals = vm->runtime.locals.base;
+    vm->runtime.locals.base = vm->runtime.locals.used;
+
+    _frame_load(vm);
+
+    return f;
 }
 
-static AVMError _parse_RefVal(AVM vm)
+/* runs the next length bytes of the current frame as a loop body */
+static struct _AVMFrame* _frame_push_inline(AVM vm, AVMFrameKind kind, uint32_t length, AVMError *err)
 {
-    AVMHash hash;
-    
-    if (vm->runtime.pos + 4 > vm->runtime.size)
+    AVMObject code  = (AVMObject)vm->runtime.frames[vm->runtime.depth-1].code;
+    size_t    start = vm->runtime.pos;
+
+    /* where the current frame resumes */
+    vm->runtime.pos += length;
+
+    /* the loop runs in the window it is in; a block it replaces hands it over */
+    struct _AVMFrame *top = &vm->runtime.frames[vm->runtime.depth-1];
+
+    uint32_t base   = vm->runtime.locals.base;
+    uint32_t locals = base;
+    uint8_t  window = _frame_replaced(vm, kind);
+
+    if (window)
     {
-        return AVM_ERROR_REF_TRUNCATED;
+        locals      = top->locals;
+        top->window = 0;
     }
-    
-    uint8_t *p = (uint8_t*)&vm->runtime.code[vm->runtime.pos];
 
-    hash = (p[0]<<24)
-         | (p[1]<<16)
-         | (p[2]<<8)
-         | (p[3]);
-    
-    vm->runtime.pos += 4;
-    
-    AVMDict dict = vm->runtime.vars;
-    AVMObject o;
+    struct _AVMFrame *f = _frame_push(vm, (AVMCode)_avm_object_copy(vm,code), kind, err);
 
-    if (!dict || !(o=avm_dict_get(dict, hash)) )
+    if (f)
     {
-        return AVM_ERROR_REF_NOT_BIND;
+        f->pos    = start;
+        f->start  = start;
+        f->end    = start + length;
+        f->window = window;
+        f->locals = locals;
+
+        vm->runtime.locals.base = base;
+
+        _frame_load(vm);
+    }
+    else if (window)
+    {
+        _locals_leave(vm, locals);
+    }
+
+    return f;
+}
+
+static void _frame_pop(AVM vm)
+{
+    struct _AVMFrame *f = &vm->runtime.frames[--vm->runtime.depth];
+
+    if (f->kind == AVMFrameCall || f->kind == AVMFrameRun)
+    {
+        _regs_restore(vm, f->saved, f->regs);
+    }
+
+    if (f->window)
+    {
+        _locals_leave(vm, f->locals);
+    }
+
+    avm_object_free(vm, (AVMObject)f->code);
+
+    if (vm->runtime.depth > 0)
+    {
+        _frame_load(vm);
+    }
+}
+
+/* the topmost frame ran to its end: loop again or return to the caller */
+static AVMError _frame_end(AVM vm)
+{
+    struct _AVMFrame *f = &vm->runtime.frames[vm->runtime.depth-1];
+
+    switch (f->kind)
+    {
+        case AVMFrameRepeat:
+            if (--f->count > 0)
+            {
+                vm->runtime.pos = f->start;
+                return AVM_NO_ERROR;
+            }
+            break;
+
+        case AVMFrameFor:
+            f->count += f->step;
+
+            if ( (f->step>0 && f->count<=f->limit)
+              || (f->step<0 && f->count>=f->limit) )
+            {
+                vm->runtime.pos = f->start;
+                return _avm_stack_push_value(vm->runtime.stack,
+                                             AVM_VALUE_FROM_INTEGER(f->count));
+            }
+            break;
+    }
+
+    _frame_pop(vm);
+    return AVM_NO_ERROR;
+}
+
+/* integers are true when not zero, strings when not empty */
+static AVMError _condition(AVMValue condition, char *b)
+{
+    switch (_avm_value_type(condition))
+    {
+        case AVMTypeInteger:
+            *b = AVM_VALUE_INTEGER(condition) != 0;
+            return AVM_NO_ERROR;
+
+        case AVMTypeString:
+            *b = ((AVMString)AVM_VALUE_OBJECT(condition))->length != 0;
+            return AVM_NO_ERROR;
+
+        default:
+            return AVM_ERROR_WRONG_TYPE;
     }
-    
+}
+
+/* runs code and externals bound to a name, pushes anything else */
+static AVMError _ref_value(AVM vm, AVMObject o)
+{
     switch (o->type)
     {
         case AVMTypeCode:
         {
-            AVMObject saved_acc = vm->runtime.acc;
-            vm->runtime.acc = 0;
-            AVMError err = _run_subroutine(vm, (AVMCode)o);
-            if (vm->runtime.acc)
-                avm_object_free(vm,vm->runtime.acc);
-            vm->runtime.acc = saved_acc;
+            AVMError err = AVM_NO_ERROR;
+            _frame_push(vm, (AVMCode)_avm_object_copy(vm,o), AVMFrameCall, &err);
             return err;
         }
-        
+
         case AVMTypeExternal:
         {
-            return (*((AVMExternal)o)->ptr)(vm,vm->runtime.stack);
+            AVMStack s   = vm->runtime.stack;
+            AVMError err = (*((AVMExternal)o)->ptr)(vm,s);
+            _avm_stack_canonicalize(s);
+            return err;
         }
 
         default:
         {
-            AVMObject oo = avm_object_copy(o);
-            return avm_stack_push(vm->runtime.stack, oo);
+            AVMValue oo = _avm_value_copy_object(vm,o);
+            return oo? _avm_stack_push_value(vm->runtime.stack, oo)
+                     : AVM_ERROR_NO_MEM;
         }
     }
 }
 
+static AVMError _parse_RefVal(AVM vm)
+{
+    uint32_t  hash;
+    AVMError  err = _read_uint32(vm,&hash);
+    AVMObject o;
+
+    if (err != AVM_NO_ERROR)
+        return err;
+
+    if (!(o=avm_dict_get(vm->runtime.vars, hash)) )
+    {
+        return AVM_ERROR_REF_NOT_BIND;
+    }
+
+    return _ref_value(vm, o);
+}
+
 static AVMError _parse_Repeat(AVM vm)
 {
    AVMStack s = vm->runtime.stack;
@@ -462,35 +531,35 @@ static AVMError _parse_Repeat(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject action    = avm_stack_at(s,0),
-              count     = avm_stack_at(s,1);
-    
-    if (count->type  != AVMTypeInteger
-     || action->type != AVMTypeCode)
+    AVMValue action    = _avm_stack_value_at(s,0),
+             count     = _avm_stack_value_at(s,1);
+
+    if (!AVM_VALUE_IS_INTEGER(count)
+     || !_avm_value_is(action, AVMTypeCode))
         return AVM_ERROR_WRONG_TYPE;
- 
-    int32_t i,
-            times = ((AVMInteger)count)->value;
-   
+
+    int32_t times = AVM_VALUE_INTEGER(count);
+
     if (times < 0)
         return AVM_ERROR_NEGATIVE_TIMES;
-    
+
     avm_stack_discard(s, 2);
 
-    AVMError err;
-    for (i=0;i<times;++i)
+    if (times == 0)
     {
-        err = _run_subroutine(vm, (AVMCode)action);
-        if (err != AVM_NO_ERROR)
-        {
-            break;
-        }
+        _avm_value_free(vm,action);
+        return AVM_NO_ERROR;
     }
-    
-    avm_object_free(vm,action);
-    avm_object_free(vm,count);
 
-    return err != AVM_NO_ERROR_EXIT? err : AVM_NO_ERROR;
+    AVMError err = AVM_NO_ERROR;
+    struct _AVMFrame *f = _frame_push(vm, (AVMCode)AVM_VALUE_OBJECT(action),
+                                      AVMFrameRepeat, &err);
+    if (f)
+    {
+        f->count = times;
+    }
+
+    return err;
 }
 
 static AVMError _parse_Times(AVM vm)
@@ -502,430 +571,570 @@ static AVMError _parse_Times(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject action    = avm_stack_at(s,1),
-              count     = avm_stack_at(s,0);
-    
-    if (count->type  != AVMTypeInteger)
+    AVMValue action    = _avm_stack_value_at(s,1),
+             count     = _avm_stack_value_at(s,0);
+
+    if (!AVM_VALUE_IS_INTEGER(count))
         return AVM_ERROR_WRONG_TYPE;
- 
+
     int32_t i,
-            times = ((AVMInteger)count)->value;
-   
+            times = AVM_VALUE_INTEGER(count);
+
     if (times < 0)
         return AVM_ERROR_NEGATIVE_TIMES;
 
     avm_stack_discard(s, 2);
 
-    AVMError err;
+    AVMError err = AVM_NO_ERROR;
 
     for (i=0;i<times;++i)
     {
-        AVMObject oo = avm_object_copy(action);
+        AVMValue oo = _avm_value_copy(vm,action);
         if (!oo)
         {
             err = AVM_ERROR_NO_MEM;
             break;
         }
-        
-        err = avm_stack_push(s,oo);
+
+        err = _avm_stack_push_value(s,oo);
         if (err != AVM_NO_ERROR)
             break;
     }
 
-    avm_object_free(vm,action);
-    avm_object_free(vm,count);
-    
+    _avm_value_free(vm,action);
+
     return err != AVM_NO_ERROR_EXIT? err : AVM_NO_ERROR;
 }
 
-static AVMError _parse_For(AVM vm)
+/* checks the bounds of a for loop and pushes its first value */
+static AVMError _for_begin(AVMValue initial, AVMValue increment, AVMValue limit,
+                           int32_t *i, int32_t *lim, int32_t *inc)
 {
-    AVMStack s = vm->runtime.stack;
+    if (   !AVM_VALUE_IS_INTEGER(limit)
+     || !AVM_VALUE_IS_INTEGER(increment)
+     ||   !AVM_VALUE_IS_INTEGER(initial))
+        return AVM_ERROR_WRONG_TYPE;
 
-    if (avm_stack_size(s) < 4)
-    {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
-    }
+    *i   = AVM_VALUE_INTEGER(initial);
+    *lim = AVM_VALUE_INTEGER(limit);
+    *inc = AVM_VALUE_INTEGER(increment);
 
-    AVMObject action    = avm_stack_at(s,0),
-              limit     = avm_stack_at(s,1),
-              increment = avm_stack_at(s,2),
-              initial   = avm_stack_at(s,3);
-    
-    if (    limit->type != AVMTypeInteger
-     || increment->type != AVMTypeInteger
-     ||   initial->type != AVMTypeInteger 
-     ||    action->type != AVMTypeCode)
-        return AVM_ERROR_WRONG_TYPE;
-    
-    int32_t i   = ((AVMInteger)initial)->value,
-            lim = ((AVMInteger)limit)->value,
-            inc = ((AVMInteger)increment)->value;
-   
-    if (inc==0 // not permitted
-     || (lim>i && inc<0)
-     || (lim<i && inc>0))
+    if (*inc==0 // not permitted
+     || (*lim>*i && *inc<0)
+     || (*lim<*i && *inc>0))
     {
         return AVM_ERROR_BAD_INCREMENT;
     }
 
-    avm_stack_discard(s, 4);
-
-    AVMError err;
+    return AVM_NO_ERROR;
+}
+
+static AVMError _parse_For(AVM vm)
+{
+    AVMStack s = vm->runtime.stack;
 
-    for (;(inc>0 && i<=lim) || (inc<0 && i>=lim) ;i+=inc)
+    if (avm_stack_size(s) < 4)
     {
-        AVMInteger ii = avm_create_integer(vm,i);
-        err = avm_stack_push(s,(AVMObject)ii);
-        if (err != AVM_NO_ERROR)
-            break;
+        return AVM_ERROR_NOT_ENOUGH_ARGS;
+    }
 
-        err = _run_subroutine(vm, (AVMCode)action);
+    AVMValue action = _avm_stack_value_at(s,0);
 
-        if (err != AVM_NO_ERROR)
-            break;
+    if (!_avm_value_is(action, AVMTypeCode))
+        return AVM_ERROR_WRONG_TYPE;
+
+    int32_t i, lim, inc;
+
+    AVMError err = _for_begin(_avm_stack_value_at(s,3),
+                              _avm_stack_value_at(s,2),
+                              _avm_stack_value_at(s,1),
+                              &i, &lim, &inc);
+    if (err != AVM_NO_ERROR)
+        return err;
+
+    avm_stack_discard(s, 4);
+
+    /* the checks above guarantee a first iteration */
+    err = _avm_stack_push_value(s,AVM_VALUE_FROM_INTEGER(i));
+
+    if (err != AVM_NO_ERROR)
+    {
+        _avm_value_free(vm,action);
+        return err;
     }
 
-    avm_object_free(vm,action);
-    avm_object_free(vm,limit);
-    avm_object_free(vm,increment);
-    avm_object_free(vm,initial);
-    
-    return err != AVM_NO_ERROR_EXIT? err : AVM_NO_ERROR;
+    struct _AVMFrame *f = _frame_push(vm, (AVMCode)AVM_VALUE_OBJECT(action),
+                                      AVMFrameFor, &err);
+    if (f)
+    {
+        f->count = i;
+        f->limit = lim;
+        f->step  = inc;
+    }
+
+    return err;
 }
 
-static AVMError _parse_Debug(AVM vm)
+/* the body follows inline: initial increment limit LoopFor <len16> body */
+static AVMError _exec_LoopFor(AVM vm, uint32_t length)
 {
-    return AVM_NO_ERROR;
-}
+    AVMStack s   = vm->runtime.stack;
+    AVMError err = AVM_NO_ERROR;
 
+    if (avm_stack_size(s) < 3)
+    {
+        return AVM_ERROR_NOT_ENOUGH_ARGS;
+    }
 
-static AVMError _parse_Break(AVM vm)
-{
-    return AVM_NO_ERROR_EXIT;
-}
+    int32_t i, lim, inc;
 
+    err = _for_begin(_avm_stack_value_at(s,2),
+                     _avm_stack_value_at(s,1),
+                     _avm_stack_value_at(s,0),
+                     &i, &lim, &inc);
+    if (err != AVM_NO_ERROR)
+        return err;
 
-#define MK_STR_BITS_FN(BITS) \
-static AVMError _parse_Str##BITS(AVM vm) \
-{ \
-    uint32_t length; \
-    AVMError err = _read_uint##BITS(vm,&length); \
-    if (err != AVM_NO_ERROR) \
-        return AVM_ERROR_REF_TRUNCATED; \
-    if (vm->runtime.pos + length > vm->runtime.size) \
-        return AVM_ERROR_STR_TRUNCATED; \
-    AVMString o = avm_create_string(&vm->runtime.code[vm->runtime.pos], \
-                                    length); \
-    if (o == NULL) \
-        return AVM_ERROR_NO_MEM; \
-    vm->runtime.pos += length; \
-    return avm_stack_push(vm->runtime.stack, (AVMObject)o); \
-}
+    avm_stack_discard(s, 3);
 
-MK_STR_BITS_FN(8)
-MK_STR_BITS_FN(16)
+    err = _avm_stack_push_value(s,AVM_VALUE_FROM_INTEGER(i));
+    if (err != AVM_NO_ERROR)
+        return err;
 
-#define MK_CODE_BITS_FN(BITS) \
-static AVMError _parse_Code##BITS (AVM vm) \
-{ \
-    uint32_t length; \
-    AVMError err = _read_uint##BITS(vm,&length); \
-    if (err != AVM_NO_ERROR) \
-        return err; \
-    if (vm->runtime.pos + length > vm->runtime.size) \
-        return AVM_ERROR_CODE_TRUNCATED; \
-    AVMCode o = avm_create_code(&vm->runtime.code[vm->runtime.pos], \
-                                length); \
-    if (o == NULL) \
-        return AVM_ERROR_NO_MEM; \
-    vm->runtime.pos += length; \
-    return avm_stack_push(vm->runtime.stack, (AVMObject)o); \
+    struct _AVMFrame *f = _frame_push_inline(vm, AVMFrameFor, length, &err);
+    if (f)
+    {
+        f->count = i;
+        f->limit = lim;
+        f->step  = inc;
+    }
+
+    return err;
 }
 
-MK_CODE_BITS_FN(8)
-MK_CODE_BITS_FN(16)
-MK_CODE_BITS_FN(24)
-MK_CODE_BITS_FN(32)
+MK_BLOB_PARSER(LoopFor, 16, AVM_ERROR_CODE_TRUNCATED)
 
-static AVMError _parse_Shl(AVM vm)
+/* count LoopRepeat <len16> body */
+static AVMError _exec_LoopRepeat(AVM vm, uint32_t length)
 {
-    AVMStack s = vm->runtime.stack;
+    AVMStack s   = vm->runtime.stack;
+    AVMError err = AVM_NO_ERROR;
 
-    if (avm_stack_size(s) < 2)
+    if (avm_stack_size(s) < 1)
     {
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject b = avm_stack_at(s,0),
-              a = avm_stack_at(s,1);
+    AVMValue count = _avm_stack_value_at(s,0);
 
-    if (a->type != AVMTypeInteger || a->type != b->type)
+    if (!AVM_VALUE_IS_INTEGER(count))
         return AVM_ERROR_WRONG_TYPE;
-    
-    uint32_t va = (uint32_t)((AVMInteger)a)->value,
-             vb = (uint32_t)((AVMInteger)b)->value;
 
-    ((AVMInteger)a)->value = (uint32_t) va << vb;
-    
-    avm_object_free(vm,b);
-    _avm_stack_set(s,1,a);
+    int32_t times = AVM_VALUE_INTEGER(count);
 
-    return avm_stack_discard(s,1);
-}
+    if (times < 0)
+        return AVM_ERROR_NEGATIVE_TIMES;
 
-static AVMError _parse_Shr(AVM vm)
-{
-    AVMStack s = vm->runtime.stack;
+    avm_stack_discard(s, 1);
 
-    if (avm_stack_size(s) < 2)
+    if (times == 0)
     {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
+        vm->runtime.pos += length;
+        return AVM_NO_ERROR;
     }
 
-    AVMObject b = avm_stack_at(s,0),
-              a = avm_stack_at(s,1);
+    struct _AVMFrame *f = _frame_push_inline(vm, AVMFrameRepeat, length, &err);
+    if (f)
+    {
+        f->count = times;
+    }
 
-    if (a->type != AVMTypeInteger || a->type != b->type)
-        return AVM_ERROR_WRONG_TYPE;
-    
-    uint32_t va = (uint32_t)((AVMInteger)a)->value,
-             vb = (uint32_t)((AVMInteger)b)->value;
+    return err;
+}
 
-    ((AVMInteger)a)->value = (uint32_t) va >> vb;
-    
-    avm_object_free(vm,b);
-    _avm_stack_set(s,1,a);
+MK_BLOB_PARSER(LoopRepeat, 16, AVM_ERROR_CODE_TRUNCATED)
+
+/*
+ * Offsets are relative to the end of the jump instruction. The target is
+ * checked when jumping, as the same instruction may run in another frame.
+ */
+static inline AVMError _jump_target(AVM vm, uint32_t offset, size_t *target)
+{
+    *target = vm->runtime.pos + (int16_t)offset;
 
-    return avm_stack_discard(s,1);
+    /* a target before the start wraps around past size */
+    return *target > vm->runtime.size? AVM_ERROR_JUMP_RANGE : AVM_NO_ERROR;
 }
 
-static AVMError _parse_And(AVM vm)
+static AVMError _exec_Jmp(AVM vm, uint32_t offset)
 {
-    AVMStack s = vm->runtime.stack;
+    size_t   target;
+    AVMError err = _jump_target(vm, offset, &target);
 
-    if (avm_stack_size(s) < 2)
-    {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
-    }
+    if (err == AVM_NO_ERROR)
+        vm->runtime.pos = target;
 
-    AVMObject b = avm_stack_at(s,0),
-              a = avm_stack_at(s,1);
+    return err;
+}
 
-    if (a->type != AVMTypeInteger || a->type != b->type)
-        return AVM_ERROR_WRONG_TYPE;
-    
-    uint32_t va = (uint32_t)((AVMInteger)a)->value,
-             vb = (uint32_t)((AVMInteger)b)->value;
+MK_OPERAND_PARSER(Jmp, 16)
+
+#define MK_COND_JUMP_FN(NAME,WHEN) \
+static AVMError _exec_ ## NAME(AVM vm, uint32_t offset) \
+{ \
+    char     b; \
+    size_t   target; \
+    AVMError err = _jump_target(vm, offset, &target); \
+    if (err != AVM_NO_ERROR) \
+        return err; \
+    if (avm_stack_size(vm->runtime.stack) < 1) \
+        return AVM_ERROR_NOT_ENOUGH_ARGS; \
+    AVMValue condition = _avm_stack_value_at(vm->runtime.stack,0); \
+    err = _condition(condition, &b); \
+    if (err != AVM_NO_ERROR) \
+        return err; \
+    _avm_value_free(vm,condition); \
+    avm_stack_discard(vm->runtime.stack, 1); \
+    if (b == WHEN) \
+        vm->runtime.pos = target; \
+    return AVM_NO_ERROR; \
+} \
+MK_OPERAND_PARSER(NAME, 16)
 
-    ((AVMInteger)a)->value = (uint32_t) va & vb;
-    
-    avm_object_free(vm,b);
-    _avm_stack_set(s,1,a);
+MK_COND_JUMP_FN(JmpZ,  0)
+MK_COND_JUMP_FN(JmpNZ, 1)
 
-    return avm_stack_discard(s,1);
+static AVMError _parse_Debug(AVM vm)
+{
+    return AVM_NO_ERROR;
 }
 
-static AVMError _parse_Or(AVM vm)
-{
-    AVMStack s = vm->runtime.stack;
 
-    if (avm_stack_size(s) < 2)
+/* leaves the innermost loop, along with any calls and blocks inside it */
+static AVMError _parse_Break(AVM vm)
+{
+    while (vm->runtime.depth > vm->runtime.base + 1)
     {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
+        AVMFrameKind kind = vm->runtime.frames[vm->runtime.depth-1].kind;
+
+        _frame_pop(vm);
+
+        if (kind == AVMFrameRepeat || kind == AVMFrameFor)
+            return AVM_NO_ERROR;
     }
 
-    AVMObject b = avm_stack_at(s,0),
-              a = avm_stack_at(s,1);
+    return AVM_NO_ERROR_EXIT;
+}
 
-    if (a->type != AVMTypeInteger || a->type != b->type)
-        return AVM_ERROR_WRONG_TYPE;
-    
-    uint32_t va = (uint32_t)((AVMInteger)a)->value,
-             vb = (uint32_t)((AVMInteger)b)->value;
 
-    ((AVMInteger)a)->value = (uint32_t) va | vb;
-    
-    avm_object_free(vm,b);
-    _avm_stack_set(s,1,a);
+#define MK_STR_BITS_FN(BITS) \
+static AVMError _exec_Str##BITS(AVM vm, uint32_t length) \
+{ \
+    AVMString o = _avm_create_string(vm, \
+                                     &vm->runtime.code[vm->runtime.pos], \
+                                     length); \
+    if (o == NULL) \
+        return AVM_ERROR_NO_MEM; \
+    vm->runtime.pos += length; \
+    return _avm_stack_push_value(vm->runtime.stack, AVM_VALUE_FROM_OBJECT(o)); \
+} \
+MK_BLOB_PARSER(Str##BITS, BITS, AVM_ERROR_STR_TRUNCATED)
+
+MK_STR_BITS_FN(8)
+MK_STR_BITS_FN(16)
+
+#define MK_CODE_BITS_FN(BITS) \
+static AVMError _exec_Code##BITS (AVM vm, uint32_t length) \
+{ \
+    AVMCode o = _avm_create_view(vm, AVMTypeCode, vm->runtime.root, \
+                                 &vm->runtime.code[vm->runtime.pos], \
+                                 length); \
+    if (o == NULL) \
+        return AVM_ERROR_NO_MEM; \
+    vm->runtime.pos += length; \
+    return _avm_stack_push_value(vm->runtime.stack, AVM_VALUE_FROM_OBJECT(o)); \
+} \
+MK_BLOB_PARSER(Code##BITS, BITS, AVM_ERROR_CODE_TRUNCATED)
+
+MK_CODE_BITS_FN(8)
+MK_CODE_BITS_FN(16)
+MK_CODE_BITS_FN(24)
+MK_CODE_BITS_FN(32)
 
-    return avm_stack_discard(s,1);
+/* pops b, replaces a with (a OP b); both must be integers */
+#define MK_BINARY_INT_FN(NAME,OP) \
+static AVMError _parse_ ## NAME(AVM vm) \
+{ \
+    AVMStack s = vm->runtime.stack; \
+    \
+    if (avm_stack_size(s) < 2) \
+    { \
+        return AVM_ERROR_NOT_ENOUGH_ARGS; \
+    } \
+    \
+    AVMValue b = _avm_stack_value_at(s,0), \
+             a = _avm_stack_value_at(s,1); \
+    \
+    if (!AVM_VALUE_IS_INTEGER(a) || !AVM_VALUE_IS_INTEGER(b)) \
+        return AVM_ERROR_WRONG_TYPE; \
+    \
+    uint32_t va = (uint32_t)AVM_VALUE_INTEGER(a), \
+             vb = (uint32_t)AVM_VALUE_INTEGER(b); \
+    \
+    _avm_stack_set_value(s,1,AVM_VALUE_FROM_INTEGER(OP)); \
+    \
+    return avm_stack_discard(s,1); \
 }
 
-static AVMError _parse_ASet(AVM vm)
+MK_BINARY_INT_FN(Shl, va << vb)
+MK_BINARY_INT_FN(Shr, va >> vb)
+MK_BINARY_INT_FN(And, va & vb)
+MK_BINARY_INT_FN(Or,  va | vb)
+MK_BINARY_INT_FN(Add, va + vb)
+MK_BINARY_INT_FN(Sub, va - vb)
+MK_BINARY_INT_FN(Mul, va * vb)
+MK_BINARY_INT_FN(Div, (int32_t)va / (int32_t)vb)
+MK_BINARY_INT_FN(Mod, (int32_t)va % (int32_t)vb)
+
+static AVMError _exec_RSet(AVM vm, uint32_t n)
 {
     AVMStack s = vm->runtime.stack;
 
+    if (n >= AVM_REGISTERS)
+    {
+        return AVM_ERROR_RANGE_CHECK;
+    }
+
     if (avm_stack_size(s) < 1)
     {
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject b = avm_stack_at(s,0);
-    
-    if (vm->runtime.acc)
+    uint16_t bit = 1 << n;
+
+    if (!(vm->runtime.regs_set & bit))
     {
-        avm_object_free(vm,vm->runtime.acc);
-    }
+        if (vm->runtime.saved.used == vm->runtime.saved.reserved)
+        {
+            uint32_t reserved = vm->runtime.saved.reserved
+                              ? vm->runtime.saved.reserved * 2
+                              : AVM_REGISTERS;
 
-    vm->runtime.acc = b;
+            struct _AVMSavedReg *ptr = realloc(vm->runtime.saved.ptr,
+                                               reserved*sizeof(*ptr));
+            if (ptr == NULL)
+            {
+                return AVM_ERROR_NO_MEM;
+            }
 
-    return avm_stack_discard(s,1);
-}
+            vm->runtime.saved.ptr      = ptr;
+            vm->runtime.saved.reserved = reserved;
+        }
 
+        struct _AVMSavedReg *r = &vm->runtime.saved.ptr[vm->runtime.saved.used++];
 
+        r->reg   = n;
+        r->value = vm->runtime.regs[n];
 
-static AVMError _parse_AGet(AVM vm)
+        vm->runtime.regs[n] = AVM_VALUE_NULL;
+    }
+
+    _avm_value_free(vm, vm->runtime.regs[n]);
+
+    vm->runtime.regs[n]   = _avm_stack_pop_value(s);
+    vm->runtime.regs_set |= bit;
+
+    return AVM_NO_ERROR;
+}
+
+static AVMError _exec_RGet(AVM vm, uint32_t n)
 {
-    AVMStack s = vm->runtime.stack;
+    if (n >= AVM_REGISTERS)
+    {
+        return AVM_ERROR_RANGE_CHECK;
+    }
 
-    if (vm->runtime.acc == NULL)
+    if (!(vm->runtime.regs_set & (1 << n)))
     {
         return AVM_ERROR_ACC_NOT_SET;
     }
 
-    AVMObject a = avm_object_copy(vm->runtime.acc);
-    
-    if (!a)
+    AVMValue v = _avm_value_copy(vm,vm->runtime.regs[n]);
+
+    if (!v)
     {
         return AVM_ERROR_NO_MEM;
     }
 
-    return avm_stack_push(s, a);
+    return _avm_stack_push_value(vm->runtime.stack, v);
 }
 
-
-static AVMError _parse_Add(AVM vm)
+static AVMError _exec_RInc(AVM vm, uint32_t n)
 {
-    AVMStack s = vm->runtime.stack;
+    if (n >= AVM_REGISTERS)
+    {
+        return AVM_ERROR_RANGE_CHECK;
+    }
 
-    if (avm_stack_size(s) < 2)
+    if (!(vm->runtime.regs_set & (1 << n)))
     {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
+        return AVM_ERROR_ACC_NOT_SET;
     }
 
-    AVMObject b = avm_stack_at(s,0),
-              a = avm_stack_at(s,1);
+    AVMValue v = vm->runtime.regs[n];
 
-    if (a->type != AVMTypeInteger || a->type != b->type)
+    if (!AVM_VALUE_IS_INTEGER(v))
         return AVM_ERROR_WRONG_TYPE;
 
-    ((AVMInteger)a)->value += ((AVMInteger)b)->value;
-    
-    avm_object_free(vm,b);
-    _avm_stack_set(s,1,a);
+    vm->runtime.regs[n] = AVM_VALUE_FROM_INTEGER((uint32_t)AVM_VALUE_INTEGER(v) + 1);
 
-    return avm_stack_discard(s,1);
+    return AVM_NO_ERROR;
 }
 
-static AVMError _parse_Inc(AVM vm)
+MK_OPERAND_PARSER(RSet, 8)
+MK_OPERAND_PARSER(RGet, 8)
+MK_OPERAND_PARSER(RInc, 8)
+
+/* the accumulator is R0 */
+static AVMError _parse_ASet(AVM vm)
 {
-    AVMStack s = vm->runtime.stack;
+    return _exec_RSet(vm, 0);
+}
 
-    if (avm_stack_size(s) < 1)
+static AVMError _parse_AGet(AVM vm)
+{
+    return _exec_RGet(vm, 0);
+}
+
+/*
+ * Locals are numbered from the start of the window of the running block,
+ * which grows up to the highest one set. Being on top, it can grow in
+ * place.
+ */
+static AVMError _local_slot(AVM vm, uint32_t n, AVMValue **slot)
+{
+    uint32_t i = vm->runtime.locals.base + n;
+
+    if (i >= vm->runtime.locals.used)
     {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
+        return AVM_ERROR_LOCAL_NOT_SET;
     }
 
-    AVMObject a = avm_stack_at(s,0);
-
-    if (a->type != AVMTypeInteger)
-        return AVM_ERROR_WRONG_TYPE;
+    *slot = &vm->runtime.locals.slots[i];
 
-    ((AVMInteger)a)->value ++;
-    
-    return AVM_NO_ERROR;
+    return **slot? AVM_NO_ERROR : AVM_ERROR_LOCAL_NOT_SET;
 }
 
-static AVMError _parse_Dec(AVM vm)
+static AVMError _exec_LSet(AVM vm, uint32_t n)
 {
     AVMStack s = vm->runtime.stack;
+    uint32_t i = vm->runtime.locals.base + n;
 
     if (avm_stack_size(s) < 1)
     {
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject a = avm_stack_at(s,0);
+    if (i >= vm->runtime.locals.reserved)
+    {
+        uint32_t  reserved = vm->runtime.locals.reserved
+                           ? vm->runtime.locals.reserved
+                           : AVM_LOCALS_INITIAL_RESERVE;
+        AVMValue *slots;
 
-    if (a->type != AVMTypeInteger)
-        return AVM_ERROR_WRONG_TYPE;
+        while (reserved <= i)
+            reserved *= 2;
 
-    ((AVMInteger)a)->value --;
-    
-    return AVM_NO_ERROR;
-}
+        slots = realloc(vm->runtime.locals.slots, reserved*sizeof(*slots));
 
-static AVMError _parse_Sub(AVM vm)
-{
-    AVMStack s = vm->runtime.stack;
+        if (slots == NULL)
+        {
+            return AVM_ERROR_NO_MEM;
+        }
 
-    if (avm_stack_size(s) < 2)
-    {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
+        vm->runtime.locals.slots    = slots;
+        vm->runtime.locals.reserved = reserved;
     }
 
-    AVMObject b = avm_stack_at(s,0),
-              a = avm_stack_at(s,1);
-
-    if (a->type != AVMTypeInteger || a->type != b->type)
-        return AVM_ERROR_WRONG_TYPE;
+    while (vm->runtime.locals.used <= i)
+    {
+        vm->runtime.locals.slots[vm->runtime.locals.used++] = AVM_VALUE_NULL;
+    }
 
-    ((AVMInteger)a)->value -= ((AVMInteger)b)->value;
+    _avm_value_free(vm, vm->runtime.locals.slots[i]);
 
-    avm_object_free(vm,b);
-    _avm_stack_set(s,1,a);
+    vm->runtime.locals.slots[i] = _avm_stack_pop_value(s);
 
-    return avm_stack_discard(s,1);
+    return AVM_NO_ERROR;
 }
 
-static AVMError _parse_Div(AVM vm)
+static AVMError _exec_LGet(AVM vm, uint32_t n)
 {
-    AVMStack s = vm->runtime.stack;
+    AVMValue *slot;
+    AVMError  err = _local_slot(vm, n, &slot);
 
-    if (avm_stack_size(s) < 2)
+    if (err != AVM_NO_ERROR)
     {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
+        return err;
     }
 
-    AVMObject b = avm_stack_at(s,0),
-              a = avm_stack_at(s,1);
-
-    if (a->type != AVMTypeInteger || a->type != b->type)
-        return AVM_ERROR_WRONG_TYPE;
-
-    ((AVMInteger)a)->value /= ((AVMInteger)b)->value;
+    AVMValue v = _avm_value_copy(vm, *slot);
 
-    avm_object_free(vm,b);
-    _avm_stack_set(s,1,a);
-
-    return avm_stack_discard(s,1);
+    return v? _avm_stack_push_value(vm->runtime.stack, v) : AVM_ERROR_NO_MEM;
 }
 
-static AVMError _parse_Mod(AVM vm)
+static AVMError _exec_LInc(AVM vm, uint32_t n)
 {
-    AVMStack s = vm->runtime.stack;
+    AVMValue *slot;
+    AVMError  err = _local_slot(vm, n, &slot);
 
-    if (avm_stack_size(s) < 2)
+    if (err != AVM_NO_ERROR)
     {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
+        return err;
     }
 
-    AVMObject b = avm_stack_at(s,0),
-              a = avm_stack_at(s,1);
-
-    if (a->type != AVMTypeInteger || a->type != b->type)
+    if (!AVM_VALUE_IS_INTEGER(*slot))
         return AVM_ERROR_WRONG_TYPE;
 
-    ((AVMInteger)a)->value %= ((AVMInteger)b)->value;
+    *slot = AVM_VALUE_FROM_INTEGER((uint32_t)AVM_VALUE_INTEGER(*slot) + 1);
+
+    return AVM_NO_ERROR;
+}
 
-    avm_object_free(vm,b);
-    _avm_stack_set(s,1,a);
+MK_OPERAND_PARSER(LSet, 8)
+MK_OPERAND_PARSER(LGet, 8)
+MK_OPERAND_PARSER(LInc, 8)
 
-    return avm_stack_discard(s,1);
+/* replaces the integer on top with (a OP) */
+#define MK_UNARY_INT_FN(NAME,OP) \
+static AVMError _parse_ ## NAME(AVM vm) \
+{ \
+    AVMStack s = vm->runtime.stack; \
+    \
+    if (avm_stack_size(s) < 1) \
+    { \
+        return AVM_ERROR_NOT_ENOUGH_ARGS; \
+    } \
+    \
+    AVMValue v = _avm_stack_value_at(s,0); \
+    \
+    if (!AVM_VALUE_IS_INTEGER(v)) \
+        return AVM_ERROR_WRONG_TYPE; \
+    \
+    int32_t a = AVM_VALUE_INTEGER(v); \
+    \
+    _avm_stack_set_value(s,0,AVM_VALUE_FROM_INTEGER(OP)); \
+    \
+    return AVM_NO_ERROR; \
 }
 
-static AVMError _parse_EqZ(AVM vm)
+MK_UNARY_INT_FN(Inc,  (uint32_t)a + 1)
+MK_UNARY_INT_FN(Dec,  (uint32_t)a - 1)
+MK_UNARY_INT_FN(EqZ,  a == 0)
+MK_UNARY_INT_FN(NeqZ, a != 0)
+MK_UNARY_INT_FN(Not,  !a)
+
+static AVMError _parse_Dup(AVM vm)
 {
     AVMStack s = vm->runtime.stack;
 
@@ -934,17 +1143,13 @@ static AVMError _parse_EqZ(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject a = avm_stack_at(s,0);
-
-    if (a->type != AVMTypeInteger)
-        return AVM_ERROR_WRONG_TYPE;
-
-    ((AVMInteger)a)->value =  ((AVMInteger)a)->value == 0;
+    AVMValue o  = _avm_stack_value_at(s,0),
+             oo = _avm_value_copy(vm,o);
 
-    return AVM_NO_ERROR;
+    return oo? _avm_stack_push_value(s, oo) : AVM_ERROR_NO_MEM;
 }
 
-static AVMError _parse_NeqZ(AVM vm)
+static AVMError _parse_Pop(AVM vm)
 {
     AVMStack s = vm->runtime.stack;
 
@@ -953,116 +1158,47 @@ static AVMError _parse_NeqZ(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject a = avm_stack_at(s,0);
-
-    if (a->type != AVMTypeInteger)
-        return AVM_ERROR_WRONG_TYPE;
-
-    ((AVMInteger)a)->value =  ((AVMInteger)a)->value != 0;
+    _avm_value_free(vm,_avm_stack_pop_value(s));
 
     return AVM_NO_ERROR;
 }
 
-static AVMError _parse_Not(AVM vm)
+static AVMError _parse_Def(AVM vm)
 {
     AVMStack s = vm->runtime.stack;
 
-    if (avm_stack_size(s) < 1)
+    if (avm_stack_size(s) < 2)
     {
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject a = avm_stack_at(s,0);
+    AVMValue value = _avm_stack_value_at(s,0),
+             key   = _avm_stack_value_at(s,1);
 
-    if (a->type != AVMTypeInteger)
-        return AVM_ERROR_WRONG_TYPE;
-
-    ((AVMInteger)a)->value = ! ((AVMInteger)a)->value;
 
-    return AVM_NO_ERROR;
-}
-
-static AVMError _parse_Mul(AVM vm)
-{
-    AVMStack s = vm->runtime.stack;
-
-    if (avm_stack_size(s) < 2)
-    {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
-    }
-
-    AVMObject b = avm_stack_at(s,0),
-              a = avm_stack_at(s,1);
-
-    if (a->type != AVMTypeInteger || a->type != b->type)
-        return AVM_ERROR_WRONG_TYPE;
-
-    ((AVMInteger)a)->value *= ((AVMInteger)b)->value;
-
-    avm_object_free(vm,b);
-    _avm_stack_set(s,1,a);
-
-    return avm_stack_discard(s,1);
-}
-
-static AVMError _parse_Dup(AVM vm)
-{
-    AVMStack s = vm->runtime.stack;
-
-    if (avm_stack_size(s) < 1)
-    {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
-    }
-
-    AVMObject o  = avm_stack_at(s,0),
-              oo = avm_object_copy(o);
-    
-    return oo? avm_stack_push(s, oo) : AVM_ERROR_NO_MEM;
-}
-
-static AVMError _parse_Pop(AVM vm)
-{
-    AVMStack s = vm->runtime.stack;
-
-    if (avm_stack_size(s) < 1)
+    if (!AVM_VALUE_IS_REF(key))
     {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
+        // TODO
+        // assert( key->type != AVMTypeString);
+        return AVM_ERROR_REF_EXPECTED;
     }
-    
-    AVMObject o = avm_stack_pop(s);
-    if (o) avm_object_free(vm,o);
-
-    return AVM_NO_ERROR;
-}
-
-static AVMError _parse_Def(AVM vm)
-{
-    AVMStack s = vm->runtime.stack;
 
-    if (avm_stack_size(s) < 2)
-    {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
-    }
+    AVMObject o = _avm_value_box(vm, value);
 
-    AVMObject value = avm_stack_at(s,0),
-              key   = avm_stack_at(s,1);
-    
-    
-    if (key->type != AVMTypeRef)
+    if (o == NULL)
     {
-        // TODO
-        // assert( key->type != AVMTypeString);
-        return AVM_ERROR_REF_EXPECTED;
+        return AVM_ERROR_NO_MEM;
     }
 
-    AVMError err = avm_set_var(vm, ((AVMRef)key)->ref, value);
+    AVMError err = avm_set_var(vm, AVM_VALUE_REF(key), o);
 
     if (err != AVM_NO_ERROR)
     {
+        if (!AVM_VALUE_IS_OBJECT(value))
+            avm_object_free(vm,o);
         return err;
     }
 
-    avm_object_free(vm,key);
     return avm_stack_discard(s, 2);
 }
 
@@ -1076,10 +1212,10 @@ static AVMError _parse_Undef(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject key   = avm_stack_at(s,0);
-    
-    
-    if (key->type != AVMTypeRef)
+    AVMValue key   = _avm_stack_value_at(s,0);
+
+
+    if (!AVM_VALUE_IS_REF(key))
     {
         // TODO
         // assert( key->type != AVMTypeString);
@@ -1089,14 +1225,12 @@ static AVMError _parse_Undef(AVM vm)
     AVMDict  dict = vm->runtime.vars;
     AVMError err = avm_stack_discard(s, 1);
 
-    if (err != AVM_NO_ERROR)
+    if (err == AVM_NO_ERROR)
     {
-        err = (dict!=NULL)? avm_dict_remove(dict, ((AVMRef)key)->ref)
+        err = (dict!=NULL)? _avm_dict_remove(vm, dict, AVM_VALUE_REF(key))
                           : AVM_NO_ERROR;
     }
 
-    avm_object_free(vm,key);
-
     return err;
 }
 
@@ -1109,13 +1243,13 @@ static AVMError _parse_Swap(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject a = avm_stack_at(s,0),
-              b = avm_stack_at(s,1);
-    
-    _avm_stack_set(s,0,b);
-    _avm_stack_set(s,1,a);
+    AVMValue a = _avm_stack_value_at(s,0),
+             b = _avm_stack_value_at(s,1);
 
-    return AVM_NO_ERROR; 
+    _avm_stack_set_value(s,0,b);
+    _avm_stack_set_value(s,1,a);
+
+    return AVM_NO_ERROR;
 }
 
 static AVMError _parse_IsMark(AVM vm)
@@ -1127,44 +1261,43 @@ static AVMError _parse_IsMark(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject  a = avm_stack_at(s,0);
-    AVMInteger b = avm_create_integer(vm,a->type == AVMTypeMark);
-    
-    if (b)
-    {
-        avm_object_free(vm,a);
-        avm_stack_discard(s,1);
-    }
+    AVMValue a = _avm_stack_value_at(s,0);
 
-    return avm_stack_push(s, (AVMObject)b);
+    _avm_value_free(vm,a);
+    _avm_stack_set_value(s,0,AVM_VALUE_FROM_INTEGER(AVM_VALUE_IS_MARK(a)));
+
+    return AVM_NO_ERROR;
 }
 
 static AVMError _parse_CTM(AVM vm)
 {
     AVMStack s = vm->runtime.stack;
 
-    uint32_t n = avm_stack_size(s);
-    if (n < 1)
+    if (avm_stack_size(s) < 1)
     {
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    
-    uint32_t i;
-    for (i=0;i<n;++i)
-    {
-        AVMObject a = avm_stack_at(s,i);
-        if (a->type == AVMTypeMark)
-            break;
-    }
-    
-    if (i<n)
+    uint32_t n;
+    AVMError err = _avm_stack_count_to_mark(s, &n);
+
+    if (err == AVM_NO_ERROR)
     {
-        AVMInteger b = avm_create_integer(vm,i);
-        return avm_stack_push(s, (AVMObject)b);
+        err = _avm_stack_push_value(s, AVM_VALUE_FROM_INTEGER(n));
     }
 
-    return AVM_ERROR_MARK_NOT_FOUND;
+    return err;
+}
+
+/* shorter strings first, then byte order */
+static inline int _string_compare(AVMString sa, AVMString sb)
+{
+    int result = sa->length - sb->length;
+
+    if (result == 0)
+        result = memcmp(sa->data, sb->data, sa->length);
+
+    return result;
 }
 
 static AVMError _compare(AVM vm,int* result)
@@ -1176,29 +1309,31 @@ static AVMError _compare(AVM vm,int* result)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject b = avm_stack_at(s,0),
-              a = avm_stack_at(s,1);
-    
-    if (a->type != b->type)
+    AVMValue b = _avm_stack_value_at(s,0),
+             a = _avm_stack_value_at(s,1);
+
+    AVMType ta = _avm_value_type(a);
+
+    if (ta != _avm_value_type(b))
     {
         return AVM_ERROR_DIFFERENT_TYPES;
     }
 
-    switch((AVMType)a->type)
+    switch(ta)
     {
         case AVMTypeInteger:
         {
-            *result = ((AVMInteger)a)->value - ((AVMInteger)b)->value;
+            *result = AVM_VALUE_INTEGER(a) - AVM_VALUE_INTEGER(b);
         }
         break;
-        
+
         case AVMTypeString:
-            *result = ((AVMString)a)->length - ((AVMString)b)->length;
-            if (*result == 0)
-                *result = memcmp(((AVMString)a)->data,
-                                 ((AVMString)b)->data,
-                                 ((AVMString)a)->length);
-            break;
+        case AVMTypeBytes:
+        {
+            *result = _string_compare((AVMString)AVM_VALUE_OBJECT(a),
+                                      (AVMString)AVM_VALUE_OBJECT(b));
+        }
+        break;
 
         default:
             return AVM_ERROR_WRONG_TYPE;
@@ -1207,10 +1342,10 @@ static AVMError _compare(AVM vm,int* result)
 
     avm_stack_discard(s, 2);
 
-    avm_object_free(vm,b);
-    avm_object_free(vm,a);
+    _avm_value_free(vm,b);
+    _avm_value_free(vm,a);
 
-    return AVM_NO_ERROR; 
+    return AVM_NO_ERROR;
 }
 
 #define MK_COMPARISION_FN(NAME,OP) \
@@ -1224,13 +1359,8 @@ static AVMError _parse_ ## NAME (AVM vm) \
         return err; \
     } \
     \
-    AVMInteger i = avm_create_integer(vm,c OP 0); \
-    if (!i) \
-    { \
-        return AVM_ERROR_NO_MEM; \
-    } \
-    \
-    return avm_stack_push(vm->runtime.stack, (AVMObject)i); \
+    return _avm_stack_push_value(vm->runtime.stack, \
+                                 AVM_VALUE_FROM_INTEGER(c OP 0)); \
 }
 
 MK_COMPARISION_FN(Eq,==)
@@ -1249,61 +1379,44 @@ static AVMError _parse_If(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject action    = avm_stack_at(s,0),
-              condition = avm_stack_at(s,1);
-    
+    AVMValue action    = _avm_stack_value_at(s,0),
+             condition = _avm_stack_value_at(s,1);
+
     char b;
-    
-    if (action->type != AVMTypeCode)
+
+    if (!_avm_value_is(action, AVMTypeCode))
         return AVM_ERROR_TYPE_NOT_EXEC;
 
-    switch ((AVMType)condition->type)
-    {
-        case AVMTypeInteger:
-            b = ((AVMInteger)condition)->value != 0;
-            break;
+    AVMError err = _condition(condition, &b);
+    if (err != AVM_NO_ERROR)
+        return err;
 
-        case AVMTypeString:
-            b = ((AVMString)condition)->length != 0;
-            break;
-        default:
-            return AVM_ERROR_WRONG_TYPE;
-    }
-    
-    avm_object_free(vm,condition);
-    condition = NULL;
+    _avm_value_free(vm,condition);
 
     avm_stack_discard(vm->runtime.stack, 2);
 
-    AVMError err = AVM_NO_ERROR;
-
     if (b)
     {
-        err = _run_subroutine(vm, (AVMCode)action);
+        _frame_push(vm, (AVMCode)AVM_VALUE_OBJECT(action), AVMFrameBlock, &err);
+    }
+    else
+    {
+        _avm_value_free(vm,action);
     }
-    avm_object_free(vm,action);
 
     return err;
 }
 
-static AVMError _parse_At(AVM vm)
+/* strings and bytes read alike */
+static inline int _has_bytes(AVMValue v)
 {
-    AVMStack s = vm->runtime.stack;
-
-    if (avm_stack_size(s) < 2)
-    {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
-    }
+    return _avm_value_is(v, AVMTypeString) || _avm_value_is(v, AVMTypeBytes);
+}
 
-    AVMObject string   = avm_stack_at(s,1),
-              position = avm_stack_at(s,0);
-    
-    
-    if (string->type != AVMTypeString || position->type != AVMTypeInteger)
-        return AVM_ERROR_WRONG_TYPE;
-    
-    int32_t pos = ((AVMInteger)position)->value;
-    int32_t len = ((AVMString)string)->length;
+/* a position in length bytes, counted from the end when negative */
+static AVMError _position(int32_t pos, uint32_t length, uint32_t *at)
+{
+    int32_t len = length;
 
     if (pos>=0)
     {
@@ -1314,14 +1427,41 @@ static AVMError _parse_At(AVM vm)
     {
         if (pos < -len)
             return AVM_ERROR_RANGE_CHECK;
-        
+
         pos = len + pos;
     }
 
-    unsigned char value = (unsigned char) ((AVMString)string)->data[pos];
-    
-    ((AVMInteger)position)->value = value;
-    
+    *at = pos;
+    return AVM_NO_ERROR;
+}
+
+static AVMError _parse_At(AVM vm)
+{
+    AVMStack s = vm->runtime.stack;
+
+    if (avm_stack_size(s) < 2)
+    {
+        return AVM_ERROR_NOT_ENOUGH_ARGS;
+    }
+
+    AVMValue string   = _avm_stack_value_at(s,1),
+             position = _avm_stack_value_at(s,0);
+
+
+    if (!_has_bytes(string) || !AVM_VALUE_IS_INTEGER(position))
+        return AVM_ERROR_WRONG_TYPE;
+
+    AVMString str = (AVMString)AVM_VALUE_OBJECT(string);
+    uint32_t  pos;
+    AVMError  err = _position(AVM_VALUE_INTEGER(position), str->length, &pos);
+
+    if (err != AVM_NO_ERROR)
+        return err;
+
+    unsigned char value = (unsigned char) str->data[pos];
+
+    _avm_stack_set_value(s,0,AVM_VALUE_FROM_INTEGER(value));
+
     return AVM_NO_ERROR;
 }
 
@@ -1334,31 +1474,33 @@ static AVMError _parse_Head(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject string   = avm_stack_at(s,0);
-    
-    if (string->type != AVMTypeString)
+    AVMValue string   = _avm_stack_value_at(s,0);
+
+    if (!_avm_value_is(string, AVMTypeString))
         return AVM_ERROR_WRONG_TYPE;
-    
-    AVMInteger o = avm_create_integer(vm,-1);
-    if (o == NULL) return AVM_ERROR_NO_MEM;
 
-    if ( ((AVMString)string)->length > 0)
+    AVMString str   = (AVMString)AVM_VALUE_OBJECT(string);
+    int32_t   value = -1;
+
+    if ( str->length > 0)
     {
-        ((AVMString)string)->length --;
+        value = str->data[0];
 
-        o->value = ((AVMString)string)->data[0];
+        if ((str = _avm_string_trim(vm, str, 1, str->length - 1)) == NULL)
+        {
+            avm_stack_discard(s,1);
+            return AVM_ERROR_NO_MEM;
+        }
 
-        memmove(((AVMString)string)->data,
-                ((AVMString)string)->data+1,
-                ((AVMString)string)->length);
+        _avm_stack_set_value(s,0,AVM_VALUE_FROM_OBJECT(str));
     }
     else
     {
         avm_stack_discard(s,1);
-        avm_object_free(vm,string);
+        _avm_value_free(vm,string);
     }
-    
-    return avm_stack_push(s, (AVMObject)o);
+
+    return _avm_stack_push_value(s, AVM_VALUE_FROM_INTEGER(value));
 }
 
 
@@ -1371,27 +1513,33 @@ static AVMError _parse_Tail(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject string   = avm_stack_at(s,0);
-    
-    if (string->type != AVMTypeString)
+    AVMValue string   = _avm_stack_value_at(s,0);
+
+    if (!_avm_value_is(string, AVMTypeString))
         return AVM_ERROR_WRONG_TYPE;
-    
-    AVMInteger o = avm_create_integer(vm,-1);
-    if (o == NULL) return AVM_ERROR_NO_MEM;
 
-    if ( ((AVMString)string)->length > 0)
+    AVMString str   = (AVMString)AVM_VALUE_OBJECT(string);
+    int32_t   value = -1;
+
+    if ( str->length > 0)
     {
-        ((AVMString)string)->length --;
+        value = str->data[str->length - 1];
+
+        if ((str = _avm_string_trim(vm, str, 0, str->length - 1)) == NULL)
+        {
+            avm_stack_discard(s,1);
+            return AVM_ERROR_NO_MEM;
+        }
 
-        o->value = ((AVMString)string)->data[((AVMString)string)->length];
+        _avm_stack_set_value(s,0,AVM_VALUE_FROM_OBJECT(str));
     }
     else
     {
         avm_stack_discard(s,1);
-        avm_object_free(vm,string);
+        _avm_value_free(vm,string);
     }
-    
-    return avm_stack_push(s, (AVMObject)o);
+
+    return _avm_stack_push_value(s, AVM_VALUE_FROM_INTEGER(value));
 }
 
 static AVMError _parse_Len(AVM vm)
@@ -1403,16 +1551,14 @@ static AVMError _parse_Len(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject string   = avm_stack_at(s,0);
-    
-    if (string->type != AVMTypeString)
+    AVMValue string   = _avm_stack_value_at(s,0);
+
+    if (!_has_bytes(string))
         return AVM_ERROR_WRONG_TYPE;
-    
-    uint32_t len = ((AVMString)string)->length;
 
-    AVMInteger o = avm_create_integer(vm,len);
-    if (o == NULL) return AVM_ERROR_NO_MEM;
-    return avm_stack_push(vm->runtime.stack, (AVMObject)o);
+    uint32_t len = ((AVMString)AVM_VALUE_OBJECT(string))->length;
+
+    return _avm_stack_push_value(s, AVM_VALUE_FROM_INTEGER(len));
 }
 
 static AVMError _parse_Expl(AVM vm)
@@ -1424,43 +1570,50 @@ static AVMError _parse_Expl(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject string = avm_stack_at(s,0);
-    
-    if (string->type != AVMTypeString)
+    AVMValue string = _avm_stack_value_at(s,0);
+
+    if (!_has_bytes(string))
         return AVM_ERROR_WRONG_TYPE;
-    
-    uint32_t len = ((AVMString)string)->length;
-    
-    AVMError err = AVM_NO_ERROR;
-    
+
+    AVMString str = (AVMString)AVM_VALUE_OBJECT(string);
+    uint32_t  len = str->length;
+
     avm_stack_discard(s, 1);
 
-    while (err==AVM_NO_ERROR && len>0)
+    if (!_avm_stack_reserve(s, len))
     {
-        --len;
-
-        AVMInteger i = avm_create_integer(vm,((AVMString)string)->data[len] );
-        err          = i ? avm_stack_push(vm->runtime.stack, (AVMObject)i)
-                         : AVM_ERROR_NO_MEM;
+        _avm_value_free(vm,string);
+        return AVM_ERROR_NO_MEM;
     }
 
-    avm_object_free(vm,string);
+    _avm_explode(s->ptr + s->used, (const uint8_t*)str->data, len);
+    s->used += len;
 
-    return err;
+    _avm_value_free(vm,string);
+
+    return AVM_NO_ERROR;
 }
 
 static AVMError _parse_Mark(AVM vm)
 {
-    AVMStack s = vm->runtime.stack;
-    
-    AVMMark mark = avm_create_mark(0);
-    
-    return mark?avm_stack_push(s, (AVMObject)mark) : AVM_ERROR_NO_MEM;
+    return _avm_stack_push_value(vm->runtime.stack, AVM_VALUE_MARK);
+}
+
+/* n bytes of s from at, sharing them: s itself when that's all of it */
+static AVMString _part(AVM vm, AVMString s, uint32_t at, uint32_t n)
+{
+    if (n == s->length)
+    {
+        s->refs ++;
+        return s;
+    }
+
+    return _avm_create_view(vm, s->type, s, s->data + at, n);
 }
 
+/* string position -> head tail, cut before position */
 static AVMError _parse_Split(AVM vm)
 {
-    /*
     AVMStack s = vm->runtime.stack;
 
     if (avm_stack_size(s) < 2)
@@ -1468,46 +1621,41 @@ static AVMError _parse_Split(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMInteger pos = (AVMInteger)avm_stack_at(s,1);
-    AVMString  str = (AVMString)avm_stack_at(s,0);
-    
-    if (pos->type != AVMTypeInteger || str->type != AVMTypeString)
+    AVMValue string   = _avm_stack_value_at(s,1),
+             position = _avm_stack_value_at(s,0);
+
+    if (!_has_bytes(string) || !AVM_VALUE_IS_INTEGER(position))
         return AVM_ERROR_WRONG_TYPE;
-    
-    int32_t p   = pos->value,
-            len = (int32_t)str->length;
-    
-    if (p>=len || p<=-len)
-        return AVM_ERROR_STRING_RANGE;
-    
-    if (p<0) p = n-p;
-
-    AVMString part = avm_create_string(a->data, ->length);
-    if (r==NULL)
-        return AVM_ERROR_NO_MEM;
 
-    if (a->length)
-    {
-        memcpy(&r->data[0], a->data, a->length);
-    }
+    AVMString str = (AVMString)AVM_VALUE_OBJECT(string);
+    int32_t   len = str->length,
+              pos = AVM_VALUE_INTEGER(position);
+
+    if (pos < 0)
+        pos += len;
 
-    if (b->length)
+    if (pos < 0 || pos > len)
+        return AVM_ERROR_RANGE_CHECK;
+
+    AVMString head = _part(vm, str, 0, pos),
+              tail = _part(vm, str, pos, len - pos);
+
+    if (head == NULL || tail == NULL)
     {
-        memcpy(&r->data[a->length], b->data, b->length);
+        avm_object_free(vm,(AVMObject)head);
+        avm_object_free(vm,(AVMObject)tail);
+        return AVM_ERROR_NO_MEM;
     }
 
-    avm_stack_discard(s,1);
-    avm_object_free(vm,(AVMObject)a);
-    avm_object_free(vm,(AVMObject)b);
-    
-    _avm_stack_set(s,0,(AVMObject)r);
+    avm_object_free(vm,(AVMObject)str);
+
+    _avm_stack_set_value(s,1,AVM_VALUE_FROM_OBJECT(head));
+    _avm_stack_set_value(s,0,AVM_VALUE_FROM_OBJECT(tail));
     return AVM_NO_ERROR;
-    */
-    return AVM_ERROR_UNIMPLEMENTED;
 }
 
-
-static AVMError _parse_Join(AVM vm)
+/* string byte -> string position, or string string -> string position */
+static AVMError _parse_Find(AVM vm)
 {
     AVMStack s = vm->runtime.stack;
 
@@ -1516,173 +1664,1180 @@ static AVMError _parse_Join(AVM vm)
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMString a = (AVMString)avm_stack_at(s,1),
-              b = (AVMString)avm_stack_at(s,0);
-    
-    if (a->type != AVMTypeString || b->type != AVMTypeString)
+    AVMValue string = _avm_stack_value_at(s,1),
+             needle = _avm_stack_value_at(s,0);
+
+    if (!_has_bytes(string) || !(AVM_VALUE_IS_INTEGER(needle) || _has_bytes(needle)))
         return AVM_ERROR_WRONG_TYPE;
 
-    AVMString r = avm_create_string_empty(a->length + b->length);
-    if (r==NULL)
-        return AVM_ERROR_NO_MEM;
+    AVMString str = (AVMString)AVM_VALUE_OBJECT(string);
+    int64_t   at;
 
-    if (a->length)
+    if (AVM_VALUE_IS_INTEGER(needle))
     {
-        memcpy(&r->data[0], a->data, a->length);
-    }
+        if ((uint32_t)AVM_VALUE_INTEGER(needle) > 255)
+            return AVM_ERROR_CHAR_VALUE;
+
+        uint8_t c = AVM_VALUE_INTEGER(needle);
 
-    if (b->length)
+        at = _avm_find((const uint8_t*)str->data, str->length, &c, 1);
+    }
+    else
     {
-        memcpy(&r->data[a->length], b->data, b->length);
+        AVMString n = (AVMString)AVM_VALUE_OBJECT(needle);
+
+        at = _avm_find((const uint8_t*)str->data, str->length,
+                       (const uint8_t*)n->data, n->length);
+        avm_object_free(vm,(AVMObject)n);
     }
 
-    avm_stack_discard(s,1);
-    avm_object_free(vm,(AVMObject)a);
-    avm_object_free(vm,(AVMObject)b);
-    
-    _avm_stack_set(s,0,(AVMObject)r);
+    _avm_stack_set_value(s,0,AVM_VALUE_FROM_INTEGER(at));
     return AVM_NO_ERROR;
 }
 
-static AVMError _parse_Impl(AVM vm)
+/* string start count -> string, the start counted from the end when negative */
+static AVMError _slice(AVM vm, AVMType type)
 {
     AVMStack s = vm->runtime.stack;
 
-    if (avm_stack_size(s) < 1)
+    if (avm_stack_size(s) < 3)
     {
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMInteger num = (AVMInteger)avm_stack_at(s,0);
-    
-    if (num->type != AVMTypeInteger)
+    AVMValue string = _avm_stack_value_at(s,2),
+             start  = _avm_stack_value_at(s,1),
+             count  = _avm_stack_value_at(s,0);
+
+    if (!(type == AVMTypeBytes? _avm_value_is(string, AVMTypeBytes) : _has_bytes(string))
+     || !AVM_VALUE_IS_INTEGER(start) || !AVM_VALUE_IS_INTEGER(count))
         return AVM_ERROR_WRONG_TYPE;
-    
-    uint32_t i,n = num->value;
-    
-    AVMError err = AVM_NO_ERROR;
-    
-    avm_stack_discard(s, 1);
-    avm_object_free(vm,(AVMObject)num);
 
-    if (avm_stack_size(s) < n)
-    {
-        return AVM_ERROR_NOT_ENOUGH_ARGS;
-    }
+    AVMString str = (AVMString)AVM_VALUE_OBJECT(string);
+    int32_t   len = str->length,
+              at  = AVM_VALUE_INTEGER(start),
+              n   = AVM_VALUE_INTEGER(count);
 
-    AVMString str = avm_create_string_empty(n);
+    if (at < 0)
+        at += len;
 
-    for (i=0;i<n;++i)
-    {
-        AVMInteger ii = (AVMInteger)avm_stack_at(s,i);
-        if (ii && ii->type == AVMTypeInteger)
-        {
-            uint32_t v = ii->value;
-            avm_object_free(vm,(AVMObject)ii);
+    if (at < 0 || at > len || n < 0 || n > len - at)
+        return AVM_ERROR_RANGE_CHECK;
 
-            if (v < 256)
-            {
-                str->data[i] = v;
-            }
-            else
-            {
-                err = AVM_ERROR_CHAR_VALUE;
-                break;
-            }
+    AVMString r = _avm_string_trim(vm, str, at, n);
 
-        }
-        else
-        {
-            err = AVM_ERROR_WRONG_TYPE;
-            break;
-        }
-    }
-    avm_stack_discard(s,n);
-    avm_stack_push(s, (AVMObject)str);
-    return err;
+    avm_stack_discard(s,3);
+
+    if (r == NULL)
+        return AVM_ERROR_NO_MEM;
+
+    return _avm_stack_push_value(s, AVM_VALUE_FROM_OBJECT(r));
 }
 
+static AVMError _parse_Substr(AVM vm)
+{
+    return _slice(vm, AVMTypeString);
+}
 
-static AVMError _parse_IfElse(AVM vm)
+static AVMError _parse_Join(AVM vm)
 {
     AVMStack s = vm->runtime.stack;
 
-    if (avm_stack_size(s) < 3)
+    if (avm_stack_size(s) < 2)
     {
         return AVM_ERROR_NOT_ENOUGH_ARGS;
     }
 
-    AVMObject actionB   = avm_stack_at(s,0),
-              action    = avm_stack_at(s,1),
-              condition = avm_stack_at(s,2);
-    
-    char b;
-    
-    if (action->type != actionB->type 
-     || action->type != AVMTypeCode)
-        return AVM_ERROR_TYPE_NOT_EXEC;
+    AVMValue va = _avm_stack_value_at(s,1),
+             vb = _avm_stack_value_at(s,0);
 
-    switch ((AVMType)condition->type)
-    {
-        case AVMTypeInteger:
-            b = ((AVMInteger)condition)->value != 0;
-            break;
+    if (!_avm_value_is(va, AVMTypeString) || !_avm_value_is(vb, AVMTypeString))
+        return AVM_ERROR_WRONG_TYPE;
 
-        case AVMTypeString:
-            b = ((AVMString)condition)->length != 0;
-            break;
-        default:
-            return AVM_ERROR_WRONG_TYPE;
-    }
-    
-    avm_object_free(vm,condition);
-    condition = NULL;
+    AVMString a = (AVMString)AVM_VALUE_OBJECT(va),
+              b = (AVMString)AVM_VALUE_OBJECT(vb);
 
-    avm_stack_discard(vm->runtime.stack, 3);
+    /* appends in place when nobody else holds a */
+    AVMString r = _avm_string_append(vm, a, b->data, b->length);
 
-    AVMError err = _run_subroutine(vm, (AVMCode) (b?action:actionB)) ;
+    avm_stack_discard(s, r? 1 : 2);
+    avm_object_free(vm,(AVMObject)b);
 
-    avm_object_free(vm,action);
-    avm_object_free(vm,actionB);
+    if (r==NULL)
+        return AVM_ERROR_NO_MEM;
 
-    return err;
+    _avm_stack_set_value(s,0,AVM_VALUE_FROM_OBJECT(r));
+    return AVM_NO_ERROR;
 }
 
-static AVMError _parse_Null(AVM vm)
+/* mark string ... string -> string, copied once */
+static AVMError _parse_JoinTM(AVM vm)
 {
-    return AVM_ERROR_NULL_OPCODE;
-}
+    AVMStack s = vm->runtime.stack;
+    uint32_t i,n;
+    uint64_t length = 0;
+    AVMError err = _avm_stack_count_to_mark(s, &n);
 
-AVMError avm_run(AVM vm, const char *code, size_t size, AVMStack s)
-{
-    AVMError err;
-    
-    if (!code || !size)
-        return AVM_NO_ERROR; // We want empty codeblocks {} to work
-        //return AVM_ERROR_NO_CODE;
-    
-    vm->runtime.code  = code;
-    vm->runtime.pos   = 0;
-    vm->runtime.size  = size;
-    vm->runtime.stack = s;
+    if (err != AVM_NO_ERROR)
+        return err;
 
-    while(vm->runtime.pos < vm->runtime.size)
+    for (i=0;i<n;++i)
     {
-        AVMOpcode op = (unsigned char)vm->runtime.code[vm->runtime.pos++];
+        AVMValue v = _avm_stack_value_at(s,i);
+
+        if (!_avm_value_is(v, AVMTypeString))
+            return AVM_ERROR_WRONG_TYPE;
+
+        length += ((AVMString)AVM_VALUE_OBJECT(v))->length;
+    }
+
+    if (length > UINT32_MAX)
+        return AVM_ERROR_NO_MEM;
+
+    AVMString str;
+
+    if (n == 1)
+    {
+        str = (AVMString)AVM_VALUE_OBJECT(_avm_stack_value_at(s,0));
+    }
+    else
+    {
+        if ((str = _avm_create_string(vm, NULL, length)) == NULL)
+            return AVM_ERROR_NO_MEM;
+
+        char *p = str->data;
+
+        for (i=n;i-->0;)
+        {
+            AVMString part = (AVMString)AVM_VALUE_OBJECT(_avm_stack_value_at(s,i));
+
+            memcpy(p, part->data, part->length);
+            p += part->length;
+            avm_object_free(vm,(AVMObject)part);
+        }
+    }
+
+    avm_stack_discard(s,n);
+    _avm_stack_set_value(s,0,AVM_VALUE_FROM_OBJECT(str));
+    return AVM_NO_ERROR;
+}
+
+static AVMError _parse_Impl(AVM vm)
+{
+    AVMStack s = vm->runtime.stack;
+
+    if (avm_stack_size(s) < 1)
+    {
+        return AVM_ERROR_NOT_ENOUGH_ARGS;
+    }
+
+    AVMValue num = _avm_stack_value_at(s,0);
+
+    if (!AVM_VALUE_IS_INTEGER(num))
+        return AVM_ERROR_WRONG_TYPE;
+
+    uint32_t i,n = AVM_VALUE_INTEGER(num);
+
+    if (avm_stack_size(s) - 1 < n)
+    {
+        return AVM_ERROR_NOT_ENOUGH_ARGS;
+    }
+
+    AVMString str = _avm_create_string(vm, NULL, n);
+
+    if (str == NULL)
+        return AVM_ERROR_NO_MEM;
+
+    /* all checked at once; the first one that isn't a byte says why */
+    if (!_avm_implode((uint8_t*)str->data, s->ptr + s->used - 1 - n, n))
+    {
+        avm_object_free(vm,(AVMObject)str);
+
+        for (i=1;AVM_VALUE_IS_INTEGER(_avm_stack_value_at(s,i));++i)
+        {
+            if ((uint32_t)AVM_VALUE_INTEGER(_avm_stack_value_at(s,i)) > 255)
+                return AVM_ERROR_CHAR_VALUE;
+        }
+
+        return AVM_ERROR_WRONG_TYPE;
+    }
+
+    avm_stack_discard(s,n);
+    _avm_stack_set_value(s,0,AVM_VALUE_FROM_OBJECT(str));
+    return AVM_NO_ERROR;
+}
+
+/*
+ * Codecs take a string or bytes, and give back the same type.
+ */
+
+static AVMError _codec_arg(AVM vm, AVMString *str)
+{
+    AVMStack s = vm->runtime.stack;
+
+    if (avm_stack_size(s) < 1)
+    {
+        return AVM_ERROR_NOT_ENOUGH_ARGS;
+    }
+
+    AVMValue v = _avm_stack_value_at(s,0);
+
+    if (!_has_bytes(v))
+        return AVM_ERROR_WRONG_TYPE;
+
+    *str = (AVMString)AVM_VALUE_OBJECT(v);
+    return AVM_NO_ERROR;
+}
+
+static AVMString _codec_result(AVM vm, AVMString str, uint32_t length)
+{
+    return str->type == AVMTypeBytes? _avm_create_bytes (vm, NULL, length)
+                                    : _avm_create_string(vm, NULL, length);
+}
+
+static AVMError _codec_done(AVM vm, AVMString str, AVMString r)
+{
+    avm_object_free(vm,(AVMObject)str);
+    _avm_stack_set_value(vm->runtime.stack,0,AVM_VALUE_FROM_OBJECT(r));
+    return AVM_NO_ERROR;
+}
+
+static AVMError _parse_B64Enc(AVM vm)
+{
+    AVMString str, r;
+    AVMError  err = _codec_arg(vm, &str);
+
+    if (err != AVM_NO_ERROR)
+        return err;
+
+    if ((r = _codec_result(vm, str, (str->length + 2) / 3 * 4)) == NULL)
+        return AVM_ERROR_NO_MEM;
+
+    _avm_base64_encode(r->data, (const uint8_t*)str->data, str->length);
+    return _codec_done(vm, str, r);
+}
+
+static AVMError _parse_B64Dec(AVM vm)
+{
+    AVMString str, r;
+    AVMError  err = _codec_arg(vm, &str);
+
+    if (err != AVM_NO_ERROR)
+        return err;
+
+    if ((r = _codec_result(vm, str, str->length / 4 * 3)) == NULL)
+        return AVM_ERROR_NO_MEM;
+
+    if (!_avm_base64_decode((uint8_t*)r->data, str->data, str->length, &r->length))
+    {
+        avm_object_free(vm,(AVMObject)r);
+        return AVM_ERROR_BAD_ENCODING;
+    }
+
+    return _codec_done(vm, str, r);
+}
+
+static AVMError _parse_HexEnc(AVM vm)
+{
+    AVMString str, r;
+    AVMError  err = _codec_arg(vm, &str);
+
+    if (err != AVM_NO_ERROR)
+        return err;
+
+    if ((r = _codec_result(vm, str, str->length * 2)) == NULL)
+        return AVM_ERROR_NO_MEM;
+
+    _avm_hex_encode(r->data, (const uint8_t*)str->data, str->length);
+    return _codec_done(vm, str, r);
+}
+
+static AVMError _parse_HexDec(AVM vm)
+{
+    AVMString str, r;
+    AVMError  err = _codec_arg(vm, &str);
+
+    if (err != AVM_NO_ERROR)
+        return err;
+
+    if ((r = _codec_result(vm, str, str->length / 2)) == NULL)
+        return AVM_ERROR_NO_MEM;
+
+    if (!_avm_hex_decode((uint8_t*)r->data, str->data, str->length))
+    {
+        avm_object_free(vm,(AVMObject)r);
+        return AVM_ERROR_BAD_ENCODING;
+    }
+
+    return _codec_done(vm, str, r);
+}
+
+/* string -> integer, the CRC-32C of its bytes */
+static AVMError _parse_CRC32C(AVM vm)
+{
+    AVMString str;
+    AVMError  err = _codec_arg(vm, &str);
+
+    if (err != AVM_NO_ERROR)
+        return err;
+
+    uint32_t crc = _avm_crc32c(0, (const uint8_t*)str->data, str->length);
+
+    avm_object_free(vm,(AVMObject)str);
+    _avm_stack_set_value(vm->runtime.stack,0,AVM_VALUE_FROM_INTEGER(crc));
+    return AVM_NO_ERROR;
+}
+
+static AVMError _parse_Bytes(AVM vm)
+{
+    AVMStack s = vm->runtime.stack;
+
+    if (avm_stack_size(s) < 1)
+    {
+        return AVM_ERROR_NOT_ENOUGH_ARGS;
+    }
+
+    AVMValue size = _avm_stack_value_at(s,0);
+
+    if (!AVM_VALUE_IS_INTEGER(size))
+        return AVM_ERROR_WRONG_TYPE;
+
+    if (AVM_VALUE_INTEGER(size) < 0)
+        return AVM_ERROR_RANGE_CHECK;
+
+    AVMBytes b = _avm_create_bytes(vm, NULL, AVM_VALUE_INTEGER(size));
+
+    if (b == NULL)
+        return AVM_ERROR_NO_MEM;
+
+    _avm_stack_set_value(s,0,AVM_VALUE_FROM_OBJECT(b));
+    return AVM_NO_ERROR;
+}
+
+/* bytes position value -> bytes */
+static AVMError _parse_BSet(AVM vm)
+{
+    AVMStack s = vm->runtime.stack;
+
+    if (avm_stack_size(s) < 3)
+    {
+        return AVM_ERROR_NOT_ENOUGH_ARGS;
+    }
+
+    AVMValue bytes    = _avm_stack_value_at(s,2),
+             position = _avm_stack_value_at(s,1),
+             value    = _avm_stack_value_at(s,0);
+
+    if (!_avm_value_is(bytes, AVMTypeBytes)
+     || !AVM_VALUE_IS_INTEGER(position) || !AVM_VALUE_IS_INTEGER(value))
+        return AVM_ERROR_WRONG_TYPE;
+
+    if ((uint32_t)AVM_VALUE_INTEGER(value) > 255)
+        return AVM_ERROR_CHAR_VALUE;
+
+    AVMBytes b = (AVMBytes)AVM_VALUE_OBJECT(bytes);
+    uint32_t pos;
+    AVMError err = _position(AVM_VALUE_INTEGER(position), b->length, &pos);
+
+    if (err != AVM_NO_ERROR)
+        return err;
+
+    avm_stack_discard(s,2);
+
+    /* in place when nobody else holds b */
+    if ((b = _avm_string_unshare(vm, b)) == NULL)
+    {
+        avm_stack_discard(s,1);
+        return AVM_ERROR_NO_MEM;
+    }
+
+    b->data[pos] = AVM_VALUE_INTEGER(value);
+
+    _avm_stack_set_value(s,0,AVM_VALUE_FROM_OBJECT(b));
+    return AVM_NO_ERROR;
+}
+
+static AVMError _parse_BSlice(AVM vm)
+{
+    return _slice(vm, AVMTypeBytes);
+}
+
+/* bytes byte -> bytes, or bytes string -> bytes, or bytes bytes -> bytes */
+static AVMError _parse_BApp(AVM vm)
+{
+    AVMStack s = vm->runtime.stack;
+
+    if (avm_stack_size(s) < 2)
+    {
+        return AVM_ERROR_NOT_ENOUGH_ARGS;
+    }
+
+    AVMValue va = _avm_stack_value_at(s,1),
+             vb = _avm_stack_value_at(s,0);
+
+    if (!_avm_value_is(va, AVMTypeBytes)
+     || !(AVM_VALUE_IS_INTEGER(vb) || _has_bytes(vb)))
+        return AVM_ERROR_WRONG_TYPE;
+
+    AVMBytes  a = (AVMBytes)AVM_VALUE_OBJECT(va),
+              r;
+
+    if (AVM_VALUE_IS_INTEGER(vb))
+    {
+        if ((uint32_t)AVM_VALUE_INTEGER(vb) > 255)
+            return AVM_ERROR_CHAR_VALUE;
+
+        char c = AVM_VALUE_INTEGER(vb);
+
+        r = _avm_string_append(vm, a, &c, 1);
+    }
+    else
+    {
+        AVMString b = (AVMString)AVM_VALUE_OBJECT(vb);
+
+        r = _avm_string_append(vm, a, b->data, b->length);
+        avm_object_free(vm,(AVMObject)b);
+    }
+
+    avm_stack_discard(s, r? 1 : 2);
+
+    if (r==NULL)
+        return AVM_ERROR_NO_MEM;
+
+    _avm_stack_set_value(s,0,AVM_VALUE_FROM_OBJECT(r));
+    return AVM_NO_ERROR;
+}
+
+/* strings to bytes and back, sharing them */
+static AVMError _retype(AVM vm, AVMType from, AVMType to)
+{
+    AVMStack s = vm->runtime.stack;
+
+    if (avm_stack_size(s) < 1)
+    {
+        return AVM_ERROR_NOT_ENOUGH_ARGS;
+    }
+
+    AVMValue v = _avm_stack_value_at(s,0);
+
+    if (!_avm_value_is(v, from))
+        return AVM_ERROR_WRONG_TYPE;
+
+    AVMString r = _avm_string_retype(vm, (AVMString)AVM_VALUE_OBJECT(v), to);
+
+    if (r == NULL)
+    {
+        avm_stack_discard(s,1);
+        return AVM_ERROR_NO_MEM;
+    }
+
+    _avm_stack_set_value(s,0,AVM_VALUE_FROM_OBJECT(r));
+    return AVM_NO_ERROR;
+}
+
+static AVMError _parse_ToBytes(AVM vm)
+{
+    return _retype(vm, AVMTypeString, AVMTypeBytes);
+}
+
+static AVMError _parse_ToStr(AVM vm)
+{
+    return _retype(vm, AVMTypeBytes, AVMTypeString);
+}
+
+
+static AVMError _parse_IfElse(AVM vm)
+{
+    AVMStack s = vm->runtime.stack;
+
+    if (avm_stack_size(s) < 3)
+    {
+        return AVM_ERROR_NOT_ENOUGH_ARGS;
+    }
+
+    AVMValue actionB   = _avm_stack_value_at(s,0),
+             action    = _avm_stack_value_at(s,1),
+             condition = _avm_stack_value_at(s,2);
+
+    char b;
+
+    if (!_avm_value_is(action,  AVMTypeCode)
+     || !_avm_value_is(actionB, AVMTypeCode))
+        return AVM_ERROR_TYPE_NOT_EXEC;
+
+    AVMError err = _condition(condition, &b);
+    if (err != AVM_NO_ERROR)
+        return err;
+
+    _avm_value_free(vm,condition);
+
+    avm_stack_discard(vm->runtime.stack, 3);
+
+    _avm_value_free(vm, b? actionB : action);
+    _frame_push(vm, (AVMCode)AVM_VALUE_OBJECT(b? action : actionB),
+                AVMFrameBlock, &err);
+
+    return err;
+}
+
+static AVMError _parse_Null(AVM vm)
+{
+    return AVM_ERROR_NULL_OPCODE;
+}
+
+void _avm_decoded_free(struct _AVMDecoded *d)
+{
+    if (d)
+    {
+        free(d->caches);
+        _avm_jit_free(d->jit);
+        free(d);
+    }
+}
+
+#include "avm/generated/superinstructions.h"
+
+/* aget 1 add aset */
+static AVMError _parse_AccInc(AVM vm)
+{
+    AVMValue v = vm->runtime.regs[0];
+
+    if (!(vm->runtime.regs_set & 1) || !AVM_VALUE_IS_INTEGER(v))
+        return _chain_AccInc(vm);
+
+    vm->runtime.regs[0] = AVM_VALUE_FROM_INTEGER((uint32_t)AVM_VALUE_INTEGER(v) + 1);
+
+    return AVM_NO_ERROR;
+}
+
+/* dup 3 gt */
+static AVMError _parse_Dup3Gt(AVM vm)
+{
+    AVMStack s = vm->runtime.stack;
+    AVMValue v = _avm_stack_value_at(s,0);
+
+    if (!AVM_VALUE_IS_INTEGER(v))
+        return _chain_Dup3Gt(vm);
+
+    return _avm_stack_push_value(s,
+               AVM_VALUE_FROM_INTEGER((int32_t)((uint32_t)AVM_VALUE_INTEGER(v) - 3) > 0));
+}
+
+/* 1 index 3 1 roll: a b -> a a b */
+static AVMError _parse_DupUnder(AVM vm)
+{
+    AVMStack s = vm->runtime.stack;
+
+    if (avm_stack_size(s) < 2)
+        return _chain_DupUnder(vm);
+
+    AVMValue b = _avm_stack_value_at(s,0),
+             a = _avm_value_copy(vm,_avm_stack_value_at(s,1));
+
+    if (!a)
+        return AVM_ERROR_NO_MEM;
+
+    AVMError err = _avm_stack_push_value(s, b);
+
+    if (err != AVM_NO_ERROR)
+    {
+        _avm_value_free(vm,a);
+        return err;
+    }
+
+    _avm_stack_set_value(s,1,a);
+
+    return AVM_NO_ERROR;
+}
+
+/* swap 1 and eqz: a b -> b (a even) */
+static AVMError _parse_SwapIsEven(AVM vm)
+{
+    AVMStack s = vm->runtime.stack;
+    AVMValue a = _avm_stack_value_at(s,1);
+
+    if (avm_stack_size(s) < 2 || !AVM_VALUE_IS_INTEGER(a))
+        return _chain_SwapIsEven(vm);
+
+    _avm_stack_set_value(s,1,_avm_stack_value_at(s,0));
+    _avm_stack_set_value(s,0,AVM_VALUE_FROM_INTEGER(!(AVM_VALUE_INTEGER(a) & 1)));
+
+    return AVM_NO_ERROR;
+}
+
+/*
+ * One opcode at a time through the parser table: the engine of compilers
+ * without labels as values, and of profiled runs.
+ */
+static AVMError _run_frames_portable(AVM vm)
+{
+    AVMProfile p = vm->profile;
+    AVMError   err;
+
+    for (;;)
+    {
+        if (vm->runtime.pos >= vm->runtime.size)
+        {
+            if (p)
+                _avm_profile_break(p);
+
+            err = _frame_end(vm);
+
+            if (err != AVM_NO_ERROR)
+                return err;
+
+            if (vm->runtime.depth == vm->runtime.base)
+                return AVM_NO_ERROR;
+
+            continue;
+        }
+
+        AVMOpcode   op    = (unsigned char)vm->runtime.code[vm->runtime.pos++];
+        const char *code  = vm->runtime.code;
+        uint32_t    depth = vm->runtime.depth;
 
         err = PARSER_TABLE[op](vm);
         
         if (err != AVM_NO_ERROR)
-            goto failure;
+            return err;
 
         vm->icount ++;
+
+        if (p)
+        {
+            if (OPCODE_INFO[op].operand == AVMOperandNone
+             && vm->runtime.depth == depth
+             && vm->runtime.code  == code)
+            {
+                _avm_profile_op(p, op);
+            }
+            else
+            {
+                _avm_profile_break(p);
+            }
+        }
+    }
+}
+
+#ifdef AVM_THREADED_DISPATCH
+
+/* adds an inline cache for a $name site, returns 0 when out of memory */
+static int _cache_slot(struct _AVMDecoded *d, AVMHash hash, uint32_t *slot)
+{
+    if (d->ncaches == d->reserved)
+    {
+        uint32_t     reserved = d->reserved? d->reserved * 2 : 8;
+        AVMRefCache *caches   = realloc(d->caches, reserved*sizeof(*caches));
+
+        if (caches == NULL)
+            return 0;
+
+        d->caches   = caches;
+        d->reserved = reserved;
+    }
+
+    AVMRefCache *c = &d->caches[d->ncaches];
+
+    c->hash       = hash;
+    c->generation = 0;
+    c->dict       = NULL;
+    c->entry      = NULL;
+
+    *slot = d->ncaches++;
+    return 1;
+}
+
+/*
+ * Decodes the instruction at pos, or returns 0 when it is invalid or runs
+ * past size; such instructions are left to their parsers to report.
+ */
+static int _decode_insn(struct _AVMDecoded *d, const uint8_t *code, size_t pos, size_t size, AVMInsn *insn)
+{
+    const AVMOpcodeInfo *info = &OPCODE_INFO[code[pos]];
+
+    uint32_t operand = 0;
+
+    if (!info->valid || pos + 1 + info->operand_bytes > size)
+        return 0;
+
+    switch (info->operand_bytes)
+    {
+        case 1: operand = AVM_DECODE_8 (code + pos + 1); break;
+        case 2: operand = AVM_DECODE_16(code + pos + 1); break;
+        case 3: operand = AVM_DECODE_24(code + pos + 1); break;
+        case 4: operand = AVM_DECODE_32(code + pos + 1); break;
+    }
+
+    insn->operand = operand;
+    insn->length  = info->operand_bytes;
+
+    switch (info->operand)
+    {
+        case AVMOperandInteger:
+            insn->operand = _sign_extend(operand, info->operand_bytes*8);
+            break;
+
+        case AVMOperandBlob:
+        case AVMOperandCode:
+        case AVMOperandLoop:
+            insn->length += operand;
+            break;
+
+        default:
+            break;
+    }
+
+    if (code[pos] == AVMOpcodeRefVal && !_cache_slot(d, operand, &insn->operand))
+        return 0;
+
+    return pos + 1 + insn->length <= size;
+}
+
+/*
+ * Decoded instructions of the current frame, indexed like its code. They
+ * belong to the root so that every block of a program shares them, and
+ * start out pointing at the decoder.
+ */
+static AVMInsn* _frame_insns(AVM vm, const void *decode)
+{
+    AVMCode root = vm->runtime.root;
+
+    if (root->decoded == NULL)
+    {
+        struct _AVMDecoded *d = malloc(sizeof(*d)
+                                     + root->length * sizeof(AVMInsn));
+        if (d == NULL)
+            return NULL;
+
+        d->caches   = NULL;
+        d->ncaches  = 0;
+        d->reserved = 0;
+        d->jit      = NULL;
+
+        uint32_t i;
+        for (i=0;i<root->length;++i)
+        {
+            d->insns[i].handler = decode;
+        }
+
+        root->decoded = d;
+    }
+
+    return root->decoded->insns + (vm->runtime.code - root->data);
+}
+
+/*
+ * Quickened forms of decoded instructions. The guard checks what a form
+ * assumes of the operands, after which the form cannot fail. They match
+ * the generic handlers, overflow included.
+ */
+static inline int _guard_II(AVMStack s)
+{
+    return s->used >= 2
+        && AVM_VALUE_IS_INTEGER(s->ptr[s->used-1])
+        && AVM_VALUE_IS_INTEGER(s->ptr[s->used-2]);
+}
+
+static inline int _guard_SS(AVMStack s)
+{
+    return s->used >= 2
+        && _avm_value_is(s->ptr[s->used-1], AVMTypeString)
+        && _avm_value_is(s->ptr[s->used-2], AVMTypeString);
+}
+
+/* replaces the two integers on top with (a OP b) */
+#define MK_QUICK_II_FN(NAME,OP) \
+static inline void _quick_ ## NAME(AVM vm) \
+{ \
+    AVMStack s  = vm->runtime.stack; \
+    uint32_t va = (uint32_t)AVM_VALUE_INTEGER(s->ptr[s->used-2]), \
+             vb = (uint32_t)AVM_VALUE_INTEGER(s->ptr[s->used-1]); \
+    \
+    s->used --; \
+    s->ptr[s->used-1] = AVM_VALUE_FROM_INTEGER(OP); \
+}
+
+MK_QUICK_II_FN(AddII, va + vb)
+MK_QUICK_II_FN(SubII, va - vb)
+MK_QUICK_II_FN(MulII, va * vb)
+MK_QUICK_II_FN(AndII, va & vb)
+MK_QUICK_II_FN(OrII,  va | vb)
+
+MK_QUICK_II_FN(EqII,  (int32_t)(va - vb) == 0)
+MK_QUICK_II_FN(NeqII, (int32_t)(va - vb) != 0)
+MK_QUICK_II_FN(LtII,  (int32_t)(va - vb) <  0)
+MK_QUICK_II_FN(LteII, (int32_t)(va - vb) <= 0)
+MK_QUICK_II_FN(GtII,  (int32_t)(va - vb) >  0)
+MK_QUICK_II_FN(GteII, (int32_t)(va - vb) >= 0)
+
+/* replaces the two strings on top with (compare(a,b) OP 0) */
+#define MK_QUICK_SS_FN(NAME,OP) \
+static inline void _quick_ ## NAME(AVM vm) \
+{ \
+    AVMStack  s  = vm->runtime.stack; \
+    AVMString sa = (AVMString)AVM_VALUE_OBJECT(s->ptr[s->used-2]), \
+              sb = (AVMString)AVM_VALUE_OBJECT(s->ptr[s->used-1]); \
+    \
+    int c = _string_compare(sa,sb); \
+    \
+    s->used --; \
+    s->ptr[s->used-1] = AVM_VALUE_FROM_INTEGER(c OP 0); \
+    \
+    avm_object_free(vm,(AVMObject)sb); \
+    avm_object_free(vm,(AVMObject)sa); \
+}
+
+MK_QUICK_SS_FN(EqSS,  ==)
+MK_QUICK_SS_FN(NeqSS, !=)
+MK_QUICK_SS_FN(LtSS,  <)
+MK_QUICK_SS_FN(LteSS, <=)
+MK_QUICK_SS_FN(GtSS,  >)
+MK_QUICK_SS_FN(GteSS, >=)
+
+/*
+ * Decoded $name sites carry an inline cache: the dict entry they found,
+ * or that there was none, holds until entries are added or removed.
+ */
+static AVMError _exec_RefVal(AVM vm, uint32_t slot)
+{
+    AVMRefCache *c    = &vm->runtime.root->decoded->caches[slot];
+    AVMDict      dict = vm->runtime.vars;
+
+    if (!dict)
+        return AVM_ERROR_REF_NOT_BIND;
+
+    if (c->generation != dict->generation || c->dict != dict)
+    {
+        vm->cache_misses ++;
+
+        c->entry      = _avm_dict_entry(dict, c->hash);
+        c->generation = dict->generation;
+        c->dict       = dict;
+    }
+    else
+    {
+        vm->cache_hits ++;
+    }
+
+    if (!c->entry || !c->entry->value)
+        return AVM_ERROR_REF_NOT_BIND;
+
+    return _ref_value(vm, c->entry->value);
+}
+
+/*
+ * Threaded dispatch: every handler ends with its own indirect jump to the
+ * next one, and code/pos/size stay in locals. Only opcodes carrying
+ * operands sync pos with vm->runtime, as their handlers read from there,
+ * and control opcodes reload all three as they may switch frames.
+ *
+ * Instructions are decoded on their first run and dispatched from then on
+ * through their decoded form, whose handler gets the operand ready made.
+ * Handlers of verified code skip checking the operand against the frame.
+ *
+ * Opcodes with quickened forms first run through a quickening handler,
+ * which switches the instruction to the form whose guard its operands
+ * pass. A form whose guard fails sends it back to the generic handler for
+ * good, so that sites seeing mixed types do not keep switching.
+ */
+static AVMError _run_frames(AVM vm)
+{
+#   include "avm/generated/dispatch-table.h"
+
+    const uint8_t *code   = (const uint8_t*)vm->runtime.code;
+    size_t         pos    = vm->runtime.pos,
+                   size   = vm->runtime.size;
+    const void   **table  = vm->runtime.verified? VERIFIED_TABLE : DECODED_TABLE;
+    AVMInsn       *insns,
+                  *insn;
+    uint32_t       icount = 0;
+    AVMError       err    = AVM_ERROR_NO_MEM;
+
+    if (vm->profile)
+        return _run_frames_portable(vm);
+
+    if ((insns = _frame_insns(vm, &&decode)) == NULL)
+        goto failure;
+
+    /* frames starting, or looping, heat their block up */
+#   ifdef AVM_NATIVE
+#       define HEAT() \
+        if ((vm->jit.threshold || vm->natives) \
+         && pos == vm->runtime.frames[vm->runtime.depth-1].start \
+         && pos < size && insns[pos].handler != &&jit) \
+        { \
+            size_t delta = (const char*)code - vm->runtime.root->data; \
+            _avm_jit_heat(vm, vm->runtime.root, delta + pos, delta + size, \
+                          PARSER_TABLE, &&jit); \
+        }
+#   else
+#       define HEAT()
+#   endif
+
+#   define RELOAD() \
+    do { \
+        code  = (const uint8_t*)vm->runtime.code; \
+        pos   = vm->runtime.pos; \
+        size  = vm->runtime.size; \
+        table = vm->runtime.verified? VERIFIED_TABLE : DECODED_TABLE; \
+        insns = _frame_insns(vm, &&decode); \
+        if (insns == NULL) { err = AVM_ERROR_NO_MEM; goto failure; } \
+        HEAT(); \
+    } while(0)
+
+#   define DISPATCH() \
+    do { \
+        if (pos >= size) goto frame_end; \
+        insn = &insns[pos++]; \
+        goto *insn->handler; \
+    } while(0)
+
+#   define AVM_THREADED_OP(NAME) \
+    _op_ ## NAME: \
+        err = _parse_ ## NAME(vm); \
+        if (err != AVM_NO_ERROR) goto failure; \
+        icount ++; \
+        DISPATCH();
+
+#   define AVM_THREADED_OPERAND_OP(NAME) \
+    _op_ ## NAME: \
+        vm->runtime.pos = pos; \
+        err = _parse_ ## NAME(vm); \
+        pos = vm->runtime.pos; \
+        if (err != AVM_NO_ERROR) goto failure; \
+        icount ++; \
+        DISPATCH();
+
+#   define AVM_THREADED_CONTROL_OP(NAME) \
+    _op_ ## NAME: \
+        vm->runtime.pos = pos; \
+        err = _parse_ ## NAME(vm); \
+        RELOAD(); \
+        if (err != AVM_NO_ERROR) goto failure; \
+        icount ++; \
+        DISPATCH();
+
+    /* decoded in a larger frame than this one: its parser reports it */
+#   define AVM_DECODED_OPERAND_OP(NAME,BITS) \
+    _dop_ ## NAME: \
+        if (pos + insn->length > size) goto _op_ ## NAME; \
+    _vop_ ## NAME: \
+        vm->runtime.pos = pos + (BITS)/8; \
+        err = _exec_ ## NAME(vm, insn->operand); \
+        pos = vm->runtime.pos; \
+        if (err != AVM_NO_ERROR) goto failure; \
+        icount ++; \
+        DISPATCH();
+
+#   define AVM_DECODED_CONTROL_OP(NAME,BITS) \
+    _dop_ ## NAME: \
+        if (pos + insn->length > size) goto _op_ ## NAME; \
+    _vop_ ## NAME: \
+        vm->runtime.pos = pos + (BITS)/8; \
+        err = _exec_ ## NAME(vm, insn->operand); \
+        RELOAD(); \
+        if (err != AVM_NO_ERROR) goto failure; \
+        icount ++; \
+        DISPATCH();
+
+#   define AVM_QUICKENING_BEGIN(NAME) \
+    _qop_ ## NAME:
+
+#   define AVM_QUICKENING_TRY(FORM,GUARD) \
+        if (_guard_ ## GUARD(vm->runtime.stack)) \
+        { \
+            insn->handler = &&_q_ ## FORM; \
+            goto _q_ ## FORM; \
+        }
+
+#   define AVM_QUICKENING_END(NAME) \
+        insn->handler = &&_op_ ## NAME; \
+        goto _op_ ## NAME;
+
+#   define AVM_QUICK_OP(FORM,NAME,GUARD) \
+    _q_ ## FORM: \
+        if (!_guard_ ## GUARD(vm->runtime.stack)) \
+        { \
+            insn->handler = &&_op_ ## NAME; \
+            goto _op_ ## NAME; \
+        } \
+        _quick_ ## FORM(vm); \
+        icount ++; \
+        DISPATCH();
+
+    DISPATCH();
+
+decode:
+    if (!_decode_insn(vm->runtime.root->decoded, code, pos-1, size, insn))
+        goto *DISPATCH_TABLE[code[pos-1]];
+
+    insn->handler = table[code[pos-1]];
+    goto *insn->handler;
+
+#   ifdef AVM_NATIVE
+    /* compiled code for the block of a larger frame is no good here */
+jit:
+    {
+        size_t delta = (const char*)code - vm->runtime.root->data;
+        const struct _AVMJitEntry *j = &vm->runtime.root->decoded->jit->entries[insn->operand];
+
+        if (j->end != delta + size)
+            goto *DISPATCH_TABLE[code[pos-1]];
+
+        vm->runtime.pos = pos - 1;
+        err = j->fn(vm, delta, j->at);
+        pos = vm->runtime.pos;
+
+        if (err != AVM_NO_ERROR)
+            goto failure;
+
+        DISPATCH();
     }
+#   endif
+
+#   include "avm/generated/dispatch-labels.h"
+
+#   undef AVM_QUICK_OP
+#   undef AVM_QUICKENING_END
+#   undef AVM_QUICKENING_TRY
+#   undef AVM_QUICKENING_BEGIN
+#   undef AVM_DECODED_CONTROL_OP
+#   undef AVM_DECODED_OPERAND_OP
+#   undef AVM_THREADED_CONTROL_OP
+#   undef AVM_THREADED_OPERAND_OP
+#   undef AVM_THREADED_OP
+
+frame_end:
+    vm->runtime.pos = pos;
+
+    err = _frame_end(vm);
+    if (err != AVM_NO_ERROR)
+        goto failure;
+
+    if (vm->runtime.depth > vm->runtime.base)
+    {
+        RELOAD();
+        DISPATCH();
+    }
+
+#   undef DISPATCH
+#   undef RELOAD
+#   undef HEAT
 
+    vm->icount += icount;
     return AVM_NO_ERROR;
 
 failure:
-    vm->error_code = err;
-    vm->error_pos  = vm->runtime.pos;
+    vm->icount     += icount;
+    vm->runtime.pos = pos;
 
     return err;
 }
+
+#else
+
+static AVMError _run_frames(AVM vm)
+{
+    return _run_frames_portable(vm);
+}
+
+#endif /* AVM_THREADED_DISPATCH */
+
+/* runs a program held in root, taking ownership of it */
+static AVMError _run_root(AVM vm, AVMCode root, AVMStack s)
+{
+    AVMStack saved_stack = vm->runtime.stack;
+    uint32_t saved_base  = vm->runtime.base;
+
+    vm->runtime.stack = s;
+    vm->runtime.base  = vm->runtime.depth;
+
+    _avm_stack_canonicalize(s);
+
+    AVMError err = AVM_NO_ERROR;
+
+    if (_frame_push(vm, root, AVMFrameRun, &err))
+    {
+        err = _run_frames(vm);
+
+        if (err != AVM_NO_ERROR)
+        {
+            /* errors are reported at their position in the program */
+            while (vm->runtime.depth > vm->runtime.base + 1)
+            {
+                _frame_pop(vm);
+            }
+
+            vm->error_code = err;
+            vm->error_pos  = vm->runtime.pos;
+
+            _frame_pop(vm);
+        }
+    }
+
+    vm->runtime.stack = saved_stack;
+    vm->runtime.base  = saved_base;
+
+    return err;
+}
+
+AVMError avm_run(AVM vm, const char *code, size_t size, AVMStack s)
+{
+    if (!code || !size)
+        return AVM_NO_ERROR; // We want empty codeblocks {} to work
+        //return AVM_ERROR_NO_CODE;
+
+    /*
+     * The program is copied once so that code literals can be views into
+     * it that outlive the caller's buffer. The copy is kept, and with it
+     * the instructions decoded, for when the same program runs again.
+     */
+    AVMCode root = vm->program;
+
+    if (root == NULL || root->length != size || memcmp(root->data, code, size))
+    {
+        root = _avm_create_code(vm, code, size);
+        if (root == NULL)
+            return AVM_ERROR_NO_MEM;
+
+        avm_object_free(vm, (AVMObject)vm->program);
+        vm->program = root;
+    }
+
+    return _run_root(vm, (AVMCode)_avm_object_copy(vm,(AVMObject)root), s);
+}
+
+AVMError avm_run_verified(AVM vm, const char *code, size_t size, AVMStack s)
+{
+    if (!code || !size)
+        return AVM_NO_ERROR;
+
+    AVMCode root = vm->verified.code;
+
+    if (root == NULL || root->length != size || memcmp(root->data, code, size))
+    {
+        uint32_t need;
+        AVMError err = _avm_verify(vm, code, size, &need);
+
+        if (err != AVM_NO_ERROR)
+            return err;
+
+        root = _avm_create_code(vm, code, size);
+        if (root == NULL)
+            return AVM_ERROR_NO_MEM;
+
+        root->flags |= AVM_CODE_VERIFIED;
+
+        avm_object_free(vm, (AVMObject)vm->verified.code);
+        vm->verified.code = root;
+        vm->verified.need = need;
+    }
+
+    if (avm_stack_size(s) < vm->verified.need)
+    {
+        _avm_set_error(vm, AVM_ERROR_NOT_ENOUGH_ARGS, 0);
+        return AVM_ERROR_NOT_ENOUGH_ARGS;
+    }
+
+    return _run_root(vm, (AVMCode)_avm_object_copy(vm,(AVMObject)root), s);
+}
@@ -16,11 +16,16 @@ AVMStack avm_stack_init_with_reserve(uint32_t entries)
 
     if (s!=NULL)
     {
-        s->used     = 0;
-        s->reserved = entries;
+        s->used      = 0;
+        s->reserved  = entries;
+        s->boxed     = AVM_STACK_NOT_BOXED;
+        s->marks     = NULL;
+        s->nmarks    = 0;
+        s->rmarks    = 0;
+        s->unindexed = AVM_STACK_INDEXED;
         if (entries)
         {
-            s->ptr = malloc( entries * sizeof(AVMObject) );
+            s->ptr = malloc( entries * sizeof(AVMValue) );
 
             if (s->ptr == NULL)
             {
@@ -46,13 +51,13 @@ void avm_stack_free(AVMStack s)
             size_t i;
             for (i=0;i<s->used;++i)
             {
-                if (s->ptr[i]) 
-                    avm_object_free(NULL,s->ptr[i]);
+                _avm_value_free(NULL,s->ptr[i]);
             }
 
             free(s->ptr);
         }
 
+        free(s->marks);
         free(s);
     }
 }
@@ -64,18 +69,18 @@ void avm_stack_clear(AVMStack s)
         uint32_t i;
         for (i=0;i<s->used;++i)
         {
-            if (s->ptr[i])
-            {
-                free(s->ptr[i]);
-                s->ptr[i] = NULL;
-            }
+            _avm_value_free(NULL,s->ptr[i]);
+            s->ptr[i] = AVM_VALUE_NULL;
         }
 
-        s->used = 0;
+        s->used      = 0;
+        s->boxed     = AVM_STACK_NOT_BOXED;
+        s->nmarks    = 0;
+        s->unindexed = AVM_STACK_INDEXED;
     }
 }
 
-static char _avm_stack_grow(AVMStack s)
+char _avm_stack_grow(AVMStack s)
 {
     if (s->reserved)
     {
@@ -87,7 +92,7 @@ static char _avm_stack_grow(AVMStack s)
     else
         s->reserved = AVM_STACK_INITIAL_RESERVE;
 
-    s->ptr = realloc(s->ptr, s->reserved * sizeof(AVMObject));
+    s->ptr = realloc(s->ptr, s->reserved * sizeof(AVMValue));
     if (!s->ptr)
     {
         s->used = s->reserved = 0;
@@ -97,17 +102,189 @@ static char _avm_stack_grow(AVMStack s)
     return 1;
 }
 
-AVMError avm_stack_push(AVMStack s, AVMObject obj)
+char _avm_stack_reserve(AVMStack s, uint32_t n)
 {
-    if (obj != NULL)
+    while (s->reserved - s->used < n)
+    {
+        if (!_avm_stack_grow(s))
+            return 0;
+    }
+
+    return 1;
+}
+
+static char _index_mark(AVMStack s, uint32_t slot)
+{
+    if (s->nmarks == s->rmarks)
+    {
+        uint32_t  r = s->rmarks? s->rmarks * 2 : AVM_STACK_INITIAL_RESERVE;
+        uint32_t *m = realloc(s->marks, r * sizeof(*m));
+
+        if (m == NULL)
+            return 0;
+
+        s->marks  = m;
+        s->rmarks = r;
+    }
+
+    s->marks[s->nmarks++] = slot;
+    return 1;
+}
+
+/* entries at or above slot are of marks popped since */
+static void _forget_marks(AVMStack s, uint32_t slot)
+{
+    while (s->nmarks && s->marks[s->nmarks-1] >= slot)
+        s->nmarks --;
+}
+
+AVMError _avm_stack_push_mark(AVMStack s, AVMValue v)
+{
+    if (s->used == s->reserved && !_avm_stack_grow(s))
+        return AVM_ERROR_NO_MEM;
+
+    _forget_marks(s, s->used);
+
+    if (!_index_mark(s, s->used))
+        return AVM_ERROR_NO_MEM;
+
+    s->ptr[s->used++] = v;
+    return AVM_NO_ERROR;
+}
+
+/*
+ * Values above the topmost mark. The index is brought up to date first,
+ * then entries whose slot holds no mark any more are dropped from the top:
+ * each is dropped once, so that's constant time but for marks moved.
+ */
+AVMError _avm_stack_count_to_mark(AVMStack s, uint32_t *n)
+{
+    if (s->unindexed < s->used)
     {
-        if (s->used == s->reserved)
+        uint32_t i;
+
+        _forget_marks(s, s->unindexed);
+
+        for (i=s->unindexed;i<s->used;++i)
         {
-            if (!_avm_stack_grow(s))
+            if (AVM_VALUE_IS_MARK(s->ptr[i]) && !_index_mark(s, i))
                 return AVM_ERROR_NO_MEM;
         }
+    }
+
+    s->unindexed = AVM_STACK_INDEXED;
+
+    while (s->nmarks)
+    {
+        uint32_t slot = s->marks[s->nmarks-1];
+
+        if (slot < s->used && AVM_VALUE_IS_MARK(s->ptr[slot]))
+        {
+            *n = s->used - 1 - slot;
+            return AVM_NO_ERROR;
+        }
 
-        s->ptr[s->used++] = obj; 
+        s->nmarks --;
+    }
+
+    return AVM_ERROR_MARK_NOT_FOUND;
+}
+
+static void _reverse(AVMValue *a, uint32_t n)
+{
+    uint32_t i, j;
+
+    for (i=0,j=n-1; i<n/2; ++i, --j)
+    {
+        AVMValue v = a[i];
+
+        a[i] = a[j];
+        a[j] = v;
+    }
+}
+
+void _avm_stack_reverse(AVMStack s, uint32_t n)
+{
+    _reverse(s->ptr + s->used - n, n);
+    _avm_stack_moved(s, n);
+}
+
+/* shorter sides of a rotation are moved through a buffer on the C stack */
+#define ROTATE_BUFFER 16
+
+/* the top d of n values go below the others, d < n */
+void _avm_stack_rotate(AVMStack s, uint32_t n, uint32_t d)
+{
+    AVMValue *a = s->ptr + s->used - n,
+              tmp[ROTATE_BUFFER];
+
+    if (d == 0)
+        return;
+
+    _avm_stack_moved(s, n);
+
+    if (d <= ROTATE_BUFFER)
+    {
+        memcpy (tmp, a + n - d, d * sizeof(*a));
+        memmove(a + d, a, (n - d) * sizeof(*a));
+        memcpy (a, tmp, d * sizeof(*a));
+    }
+    else if (n - d <= ROTATE_BUFFER)
+    {
+        memcpy (tmp, a, (n - d) * sizeof(*a));
+        memmove(a, a + n - d, d * sizeof(*a));
+        memcpy (a + d, tmp, (n - d) * sizeof(*a));
+    }
+    else
+    {
+        _reverse(a, n);
+        _reverse(a, d);
+        _reverse(a + d, n - d);
+    }
+}
+
+/* pushes copies of the top n values, in the same order */
+AVMError _avm_stack_copy(AVM vm, AVMStack s, uint32_t n)
+{
+    uint32_t i;
+
+    if (n == 0)
+        return AVM_NO_ERROR;
+
+    if (!_avm_stack_reserve(s, n))
+        return AVM_ERROR_NO_MEM;
+
+    AVMValue *from = s->ptr + s->used - n,
+             *to   = s->ptr + s->used;
+
+    memcpy(to, from, n * sizeof(*to));
+    _avm_stack_moved(s, n);
+
+    for (i=0;i<n;++i)
+    {
+        if (AVM_VALUE_IS_OBJECT(to[i]) && to[i]
+         && !(to[i] = _avm_value_copy(vm, to[i])))
+        {
+            s->used += i;
+            return AVM_ERROR_NO_MEM;
+        }
+    }
+
+    s->used += n;
+    return AVM_NO_ERROR;
+}
+
+/*
+ * The public API deals in objects: immediates are unboxed on push, and boxed
+ * on the way out. avm_stack_at returns a borrowed object, so the box is
+ * stored back in the slot and undone by the VM once control returns to it.
+ */
+
+AVMError avm_stack_push(AVMStack s, AVMObject obj)
+{
+    if (obj != NULL)
+    {
+        return _avm_stack_push_value(s, _avm_value_unbox(NULL, obj));
     }
 
     return AVM_NO_ERROR;
@@ -115,12 +292,31 @@ AVMError avm_stack_push(AVMStack s, AVMObject obj)
 
 AVMObject avm_stack_at(AVMStack s, uint32_t pos)
 {
-    return (pos < s->used)? s->ptr[s->used - 1 - pos] : NULL;
+    AVMValue v = _avm_stack_value_at(s, pos);
+
+    if (v && !AVM_VALUE_IS_OBJECT(v))
+    {
+        AVMObject o = _avm_value_box(NULL, v);
+
+        if (o == NULL)
+            return NULL;
+
+        uint32_t n = s->used - 1 - pos;
+
+        s->ptr[n] = AVM_VALUE_FROM_OBJECT(o);
+        if (n < s->boxed)
+            s->boxed = n;
+
+        return o;
+    }
+
+    return AVM_VALUE_OBJECT(v);
 }
 
 AVMObject avm_stack_pop(AVMStack s)
 {
-    return s->used? s->ptr[ -- s->used] : NULL;
+    AVMValue v = _avm_stack_pop_value(s);
+    return v? _avm_value_box(NULL, v) : NULL;
 }
 
 AVMError avm_stack_discard(AVMStack s, uint32_t n)
@@ -140,12 +336,28 @@ uint32_t avm_stack_size(AVMStack s)
     return s->used;
 }
 
-void _avm_stack_set(AVMStack s, uint32_t n, AVMObject o)
+void _avm_stack_unbox(AVMStack s)
 {
-    if (n < s->used)
+    uint32_t i;
+    for (i=s->boxed;i<s->used;++i)
     {
-        s->ptr[s->used - 1 - n] = o;
+        AVMValue v = s->ptr[i];
+
+        if (v && AVM_VALUE_IS_OBJECT(v))
+        {
+            switch (AVM_VALUE_OBJECT(v)->type)
+            {
+                case AVMTypeInteger:
+                case AVMTypeRef:
+                case AVMTypeMark:
+                    s->ptr[i] = _avm_value_unbox(NULL, AVM_VALUE_OBJECT(v));
+                    break;
+            }
+        }
     }
+
+    _avm_stack_moved(s, s->used - s->boxed);
+    s->boxed = AVM_STACK_NOT_BOXED;
 }
 
 void avm_stack_print(AVMStack s)
@@ -158,11 +370,12 @@ void avm_stack_print(AVMStack s)
     
     for (i=0;i<siz;++i)
     {
-        AVMObject o = avm_stack_at(s,i);
+        AVMValue v = _avm_stack_value_at(s,i);
 
-        printf(" at %u [%p] ", i, o);
+        printf(" at %u [%p] ", i,
+               AVM_VALUE_IS_OBJECT(v)? (void*)AVM_VALUE_OBJECT(v) : NULL);
 
-        switch( (AVMType)o->type )
+        switch( _avm_value_type(v) )
         {
             case AVMTypeObject:
                 printf("*** object ***");
@@ -173,37 +386,54 @@ void avm_stack_print(AVMStack s)
                 break;
 
             case AVMTypeInteger:
-                tmp = avm_integer_get((AVMInteger)o);
+                tmp = AVM_VALUE_IS_INTEGER(v)
+                    ? (uint32_t)AVM_VALUE_INTEGER(v)
+                    : (uint32_t)avm_integer_get((AVMInteger)AVM_VALUE_OBJECT(v));
                 printf("int  %d [0x%x]", (int)tmp, tmp);
                 if (tmp<128 && tmp>0x20)
                     printf(" '%c'", tmp);
                 break;
 
             case AVMTypeString:
-                tmp = avm_string_length((AVMString)o);
+                tmp = avm_string_length((AVMString)AVM_VALUE_OBJECT(v));
                 printf("str  (%u) \"", tmp);
-                fwrite(avm_string_data((AVMString)o), tmp, 1, stdout);
+                fwrite(avm_string_data((AVMString)AVM_VALUE_OBJECT(v)), tmp, 1, stdout);
                 printf("\"");
                 break;
 
             case AVMTypeCode:
-                tmp = avm_string_length((AVMString)o);
+                tmp = avm_string_length((AVMString)AVM_VALUE_OBJECT(v));
                 printf("code {%u bytes}", tmp);
                 break;
 
+            case AVMTypeBytes:
+            {
+                const unsigned char *p = (const unsigned char*)
+                    avm_string_data((AVMString)AVM_VALUE_OBJECT(v));
+
+                tmp = avm_string_length((AVMString)AVM_VALUE_OBJECT(v));
+                printf("bytes (%u) <", tmp);
+                while (tmp--)
+                    printf("%02x", *p++);
+                printf(">");
+                break;
+            }
+
             case AVMTypeRef:
-                printf("ref  @<%08x>",avm_ref_get((AVMRef)o));
+                printf("ref  @<%08x>",
+                       AVM_VALUE_IS_REF(v)
+                       ? AVM_VALUE_REF(v)
+                       : avm_ref_get((AVMRef)AVM_VALUE_OBJECT(v)));
                 break;
             
             case AVMTypeExternal:
-                printf("external %p", ((AVMExternal)o)->ptr);
+                printf("external %p", ((AVMExternal)AVM_VALUE_OBJECT(v))->ptr);
                 break;
 
             default:
-                printf("*** unknown %u ***", o->type);
+                printf("*** unknown %u ***", _avm_value_type(v));
         }
 
         printf("\n");
     }
 }
-
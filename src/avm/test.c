@@ -1,8 +1,13 @@
 #include <avm/avm.h>
+#include <avm/generated/opcodes.h>
+#include <avm/generated/opcode-name-table.h>
+#include <avm/generated/superinstruction-table.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 
+#define PROFILE_SHOWN 16
+
 static char* read_file(char *name, size_t *pSizeOut)
 {
     FILE *f = fopen(name, "rb");
@@ -46,6 +51,52 @@ static char* read_file(char *name, size_t *pSizeOut)
     return ptr;
 }
 
+/* superinstructions have no mnemonic, so they go by their name */
+static void print_opcode(AVMOpcode op)
+{
+    int i;
+
+    for (i=0;OPCODE_TABLE[i].name && OPCODE_TABLE[i].op != op;++i)
+        ;
+
+    if (OPCODE_TABLE[i].name)
+    {
+        printf(" %s", OPCODE_TABLE[i].name);
+        return;
+    }
+
+    for (i=0;SUPERINSTRUCTION_TABLE[i].name && SUPERINSTRUCTION_TABLE[i].op != op;++i)
+        ;
+
+    if (SUPERINSTRUCTION_TABLE[i].name)
+        printf(" %s", SUPERINSTRUCTION_TABLE[i].name);
+    else if (op >= AVMOpcode0 && op <= AVMOpcode7)
+        printf(" %d", op - AVMOpcode0);
+    else if (op >= AVMOpcodeN1 && op <= AVMOpcodeN7)
+        printf(" -%d", op - AVMOpcodeN1 + 1);
+    else
+        printf(" 0x%02x", op);
+}
+
+static void print_ngrams(AVM vm)
+{
+    AVMNgramStats ngrams[PROFILE_SHOWN];
+    uint32_t      n = avm_stats_ngrams(vm, ngrams, PROFILE_SHOWN),
+                  i, j;
+
+    for (i=0;i<n && i<PROFILE_SHOWN;++i)
+    {
+        printf("Profile %10u:", ngrams[i].count);
+
+        for (j=0;j<ngrams[i].length;++j)
+        {
+            print_opcode(ngrams[i].ops[j]);
+        }
+
+        printf("\n");
+    }
+}
+
 AVMError test_callback(AVM vm, AVMStack stack)
 {
     AVMString hw = avm_create_cstring("Hello world!");
@@ -60,7 +111,29 @@ int main(int argc, char *argv[])
     
     avm_tune(vm,64);
 
-    clock_t took;
+    /* AVM_PROFILE=n counts opcode sequences of up to n */
+    if (getenv("AVM_PROFILE"))
+    {
+        avm_profile(vm, atoi(getenv("AVM_PROFILE")));
+    }
+
+    /* AVM_JIT=n compiles blocks after n starts, 0 turns the JIT off */
+    if (getenv("AVM_JIT") || getenv("AVM_PERF_MAP"))
+    {
+        uint32_t threshold = getenv("AVM_JIT")? atoi(getenv("AVM_JIT"))
+                                              : AVM_JIT_DEFAULT_THRESHOLD;
+
+        avm_jit(vm, threshold, getenv("AVM_PERF_MAP")? AVM_JIT_PERF_MAP : 0);
+    }
+
+    /* AVM_NATIVE=module.so, as built from the output of avm2c */
+    if (getenv("AVM_NATIVE") && avm_load_native(vm, getenv("AVM_NATIVE")))
+    {
+        fprintf(stderr, "Can't load %s\n", getenv("AVM_NATIVE"));
+        return 2;
+    }
+
+    clock_t took = 0;
     
     AVMError e;
     
@@ -95,7 +168,42 @@ int main(int argc, char *argv[])
             ((double)icount/ (t*1000000.0))
             );
 
+    AVMPoolStats pool[16];
+    uint32_t     nclasses = avm_stats_pool(vm, pool, 16);
+
+    for (i=0;i<nclasses && i<16;++i)
+    {
+        if (pool[i].hits || pool[i].misses)
+        {
+            printf("Pool %5u bytes: %u hits, %u misses, %u cached\n",
+                   pool[i].block_size, pool[i].hits, pool[i].misses,
+                   pool[i].cached);
+        }
+    }
     
+    AVMCacheStats cache;
+    avm_stats_cache(vm, &cache);
+
+    if (cache.hits || cache.misses)
+    {
+        printf("Inline caches: %u hits, %u misses\n", cache.hits, cache.misses);
+    }
+
+    AVMJitStats jit;
+    avm_stats_jit(vm, &jit);
+
+    if (jit.blocks)
+    {
+        printf("JIT: %u blocks, %u bytes\n", jit.blocks, jit.bytes);
+    }
+
+    if (jit.natives)
+    {
+        printf("Native: %u blocks\n", jit.natives);
+    }
+    
+    print_ngrams(vm);
+
     avm_stack_print(s);
 
     if (e != AVM_NO_ERROR)
@@ -0,0 +1,186 @@
+#include "avm/internals.h"
+
+#include "avm/generated/opcodes.h"
+#include "avm/generated/opcode-info.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Static checks of a program before it runs: every opcode exists, no
+ * operand or nested block runs past the end of its block, and jumps land
+ * on an instruction of the block they belong to. Inline loop bodies are
+ * blocks of their own, as they run in a frame of their own.
+ *
+ * Stack effects are tracked from the start of the program up to the first
+ * instruction whose effect depends on run time values, which gives the
+ * number of stack entries the program provably needs on entry.
+ */
+
+typedef struct
+{
+    const uint8_t *code;
+    uint8_t       *starts; /* bitmap of instruction starts */
+    size_t         error_pos;
+} Verifier;
+
+#define IS_START(V,P)  ((V)->starts[(P)>>3] &   (1<<((P)&7)))
+#define SET_START(V,P) ((V)->starts[(P)>>3] |=  (1<<((P)&7)))
+#define CLR_START(V,P) ((V)->starts[(P)>>3] &= ~(1<<((P)&7)))
+
+static uint32_t _operand(const uint8_t *p, uint32_t bytes)
+{
+    uint32_t value = 0;
+
+    while (bytes--)
+    {
+        value = (value<<8) | *p++;
+    }
+
+    return value;
+}
+
+/* position after the instruction at pos, including inline data */
+static size_t _next(Verifier *v, size_t pos)
+{
+    const AVMOpcodeInfo *info = &OPCODE_INFO[v->code[pos]];
+
+    size_t next = pos + 1 + info->operand_bytes;
+
+    switch (info->operand)
+    {
+        case AVMOperandBlob:
+        case AVMOperandCode:
+        case AVMOperandLoop:
+            return next + _operand(&v->code[pos+1], info->operand_bytes);
+
+        default:
+            return next;
+    }
+}
+
+static AVMError _verify_block(Verifier *v, size_t start, size_t end, uint32_t *need)
+{
+    size_t   pos;
+    int32_t  depth = 0; /* relative to the block entry */
+    AVMError err   = AVM_NO_ERROR;
+
+    /* instructions, operand bounds and nested blocks */
+    for (pos=start; pos<end; pos=_next(v,pos))
+    {
+        uint8_t              op   = v->code[pos];
+        const AVMOpcodeInfo *info = &OPCODE_INFO[op];
+
+        v->error_pos = pos;
+
+        if (!info->valid)
+            return op == AVMOpcodeNull? AVM_ERROR_NULL_OPCODE
+                                      : AVM_ERROR_INVALID_OPCODE;
+
+        if (pos + 1 + info->operand_bytes > end)
+            return AVM_ERROR_REF_TRUNCATED;
+
+        SET_START(v,pos);
+
+        size_t   data   = pos + 1 + info->operand_bytes;
+        uint32_t length = _operand(&v->code[pos+1], info->operand_bytes);
+
+        switch (info->operand)
+        {
+            case AVMOperandBlob:
+                if (data + length > end)
+                    return AVM_ERROR_STR_TRUNCATED;
+                break;
+
+            case AVMOperandCode:
+            case AVMOperandLoop:
+                if (data + length > end)
+                    return AVM_ERROR_CODE_TRUNCATED;
+
+                err = _verify_block(v, data, data + length, NULL);
+                if (err != AVM_NO_ERROR)
+                    return err;
+                break;
+
+            default:
+                break;
+        }
+
+        if (need != NULL)
+        {
+            if (info->pops < 0
+             || info->operand == AVMOperandJump
+             || info->operand == AVMOperandLoop)
+            {
+                need = NULL;
+            }
+            else
+            {
+                if (info->pops - depth > (int32_t)*need)
+                    *need = info->pops - depth;
+
+                depth += info->pushes - info->pops;
+            }
+        }
+    }
+
+    /* jumps, now that every instruction of this block is known */
+    for (pos=start; pos<end && err==AVM_NO_ERROR; pos=_next(v,pos))
+    {
+        const AVMOpcodeInfo *info = &OPCODE_INFO[v->code[pos]];
+
+        if (info->operand == AVMOperandJump)
+        {
+            size_t  next   = pos + 1 + info->operand_bytes;
+            int32_t offset = (int16_t)_operand(&v->code[pos+1], info->operand_bytes);
+
+            if ( (offset < 0 && (size_t)-offset > next - start)
+              || (offset > 0 && next + offset > end)
+              || (next + offset < end && !IS_START(v, next + offset)) )
+            {
+                v->error_pos = pos;
+                err = AVM_ERROR_JUMP_RANGE;
+            }
+        }
+    }
+
+    /* a jump from the enclosing block must not land in this one */
+    for (pos=start; pos<end; pos=_next(v,pos))
+    {
+        CLR_START(v,pos);
+    }
+
+    return err;
+}
+
+AVMError _avm_verify(AVM vm, const char *code, size_t size, uint32_t *need)
+{
+    Verifier v;
+
+    *need = 0;
+
+    v.code      = (const uint8_t*)code;
+    v.starts    = calloc(size/8 + 1, 1);
+    v.error_pos = 0;
+
+    if (v.starts == NULL)
+        return AVM_ERROR_NO_MEM;
+
+    AVMError err = _verify_block(&v, 0, size, need);
+
+    free(v.starts);
+
+    if (err != AVM_NO_ERROR)
+    {
+        _avm_set_error(vm, err, v.error_pos);
+    }
+
+    return err;
+}
+
+AVMError avm_verify(AVM vm, const char *code, size_t size)
+{
+    uint32_t need;
+
+    return _avm_verify(vm, code, size, &need);
+}
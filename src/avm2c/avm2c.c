@@ -0,0 +1,512 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avm/internals.h>
+
+#include <avm/generated/opcodes.h>
+#include <avm/generated/opcode-info.h>
+#include <avm/generated/opcode-name-table.h>
+
+/*
+ * Translates a compiled program to C, one function per block: the program
+ * itself, its code literals and its inline loop bodies. Instructions get
+ * the fast paths of avm/native.h, calls of their parsers otherwise, and
+ * control opcodes hand over to the interpreter, as in the JIT. Build the
+ * output with
+ *
+ *     cc -O2 -shared -fPIC -I<src> prog.c -o prog.so
+ *
+ * and load it with avm_load_native.
+ */
+
+/* shorter blocks are cheaper to interpret than to enter */
+#define MIN_BLOCK_INSNS 4
+
+typedef struct
+{
+    size_t start,
+           end;
+} Block;
+
+typedef struct
+{
+    const uint8_t *code;
+    size_t         size;
+    Block         *blocks;
+    size_t         nblocks,
+                   reserved,
+                   ntranslated;
+} Program;
+
+/* position after the instruction at pos, or 0 when it isn't one */
+static size_t next_insn(const uint8_t *code, size_t pos, size_t end)
+{
+    const AVMOpcodeInfo *info = &OPCODE_INFO[code[pos]];
+    size_t               next = pos + 1 + info->operand_bytes;
+    uint32_t             len  = 0;
+    int                  i;
+
+    if (!info->valid || next > end)
+        return 0;
+
+    switch (info->operand)
+    {
+        case AVMOperandBlob:
+        case AVMOperandCode:
+        case AVMOperandLoop:
+            for (i=0;i<info->operand_bytes;++i)
+                len = (len << 8) | code[pos+1+i];
+            break;
+
+        default:
+            break;
+    }
+
+    return next + len <= end? next + len : 0;
+}
+
+static uint32_t operand(const uint8_t *code, size_t pos)
+{
+    const AVMOpcodeInfo *info = &OPCODE_INFO[code[pos]];
+    uint32_t             v    = 0;
+    int                  i;
+
+    for (i=0;i<info->operand_bytes;++i)
+        v = (v << 8) | code[pos+1+i];
+
+    return v;
+}
+
+/* a comment naming op, when the compiler knows it */
+static void write_name(FILE *f, AVMOpcode op)
+{
+    size_t i;
+    for (i=0;OPCODE_TABLE[i].name != NULL;++i)
+    {
+        if (OPCODE_TABLE[i].op == op)
+        {
+            fprintf(f, " /* %s */", OPCODE_TABLE[i].name);
+            break;
+        }
+    }
+
+    fprintf(f, "\n");
+}
+
+static int add_block(Program *p, size_t start, size_t end)
+{
+    size_t i;
+
+    /* the same bytes run the same function */
+    for (i=0;i<p->nblocks;++i)
+    {
+        if (p->blocks[i].end - p->blocks[i].start == end - start
+         && !memcmp(p->code + p->blocks[i].start, p->code + start, end - start))
+            return 0;
+    }
+
+    if (p->nblocks == p->reserved)
+    {
+        size_t reserved = p->reserved? p->reserved * 2 : 16;
+        Block *blocks   = realloc(p->blocks, reserved * sizeof(*blocks));
+
+        if (blocks == NULL)
+            return 1;
+
+        p->blocks   = blocks;
+        p->reserved = reserved;
+    }
+
+    p->blocks[p->nblocks].start = start;
+    p->blocks[p->nblocks].end   = end;
+    p->nblocks ++;
+
+    return 0;
+}
+
+/* the blocks nested in the one at i, appended after it */
+static int find_blocks(Program *p, size_t i)
+{
+    size_t start = p->blocks[i].start,
+           end   = p->blocks[i].end,
+           pos,
+           next;
+
+    for (pos=start; pos<end && (next=next_insn(p->code,pos,end)); pos=next)
+    {
+        const AVMOpcodeInfo *info = &OPCODE_INFO[p->code[pos]];
+
+        if ( (info->operand == AVMOperandCode || info->operand == AVMOperandLoop)
+          && pos + 1 + info->operand_bytes < next )
+        {
+            if (add_block(p, pos + 1 + info->operand_bytes, next))
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+static size_t count_insns(const uint8_t *code, size_t end)
+{
+    size_t pos, next, n = 0;
+
+    for (pos=0; pos<end && (next=next_insn(code,pos,end)); pos=next)
+        ++n;
+
+    return n;
+}
+
+/* 1 at each instruction start, and at where decoding stops */
+static void mark_insns(const uint8_t *code, size_t end, char *insns)
+{
+    size_t pos, next;
+
+    memset(insns, 0, end + 1);
+
+    for (pos=0; pos<end && (next=next_insn(code,pos,end)); pos=next)
+        insns[pos] = 1;
+
+    insns[pos] = 1;
+}
+
+/* where the jump at pos goes, or -1 when it leaves the block */
+static long jump_target(const uint8_t *code, size_t pos, size_t next,
+                        size_t end, const char *insns)
+{
+    long target = (long)next + (int16_t)operand(code, pos);
+
+    return target >= 0 && (size_t)target <= end && insns[target]? target : -1;
+}
+
+static int is_jump(AVMOpcode op)
+{
+    return op == AVMOpcodeJmp || op == AVMOpcodeJmpZ || op == AVMOpcodeJmpNZ;
+}
+
+static void write_insn(FILE *f, const uint8_t *code, size_t pos, size_t next,
+                       size_t end, const char *insns)
+{
+    AVMOpcode            op   = code[pos];
+    const AVMOpcodeInfo *info = &OPCODE_INFO[op];
+    uint32_t             v    = operand(code, pos);
+
+    if (info->control)
+    {
+        fprintf(f, "    AVM_NATIVE_EXIT(%zu);", pos);
+        write_name(f, op);
+        return;
+    }
+
+    if (is_jump(op))
+    {
+        long target = jump_target(code, pos, next, end, insns);
+
+        if (target < 0)
+        {
+            fprintf(f, "    AVM_NATIVE_EXIT(%zu);\n", pos);
+            return;
+        }
+
+        if (op == AVMOpcodeJmp)
+            fprintf(f, "    AVM_NATIVE_COUNT(); goto L%ld;\n", target);
+        else
+            fprintf(f, "    AVM_NATIVE_JUMP_IF(%zu, 0x%02x, %d, %ld, L%ld);\n",
+                    pos, op, op == AVMOpcodeJmpNZ, target, target);
+        return;
+    }
+
+    if (op >= AVMOpcode0 && op <= AVMOpcode7)
+    {
+        fprintf(f, "    AVM_NATIVE_OP(%zu, 0x%02x, _avm_native_push(s, AVM_VALUE_FROM_INTEGER(%d)));\n",
+                pos, op, op - AVMOpcode0);
+        return;
+    }
+
+    if (op >= AVMOpcodeN1 && op <= AVMOpcodeN7)
+    {
+        fprintf(f, "    AVM_NATIVE_OP(%zu, 0x%02x, _avm_native_push(s, AVM_VALUE_FROM_INTEGER(%d)));\n",
+                pos, op, AVMOpcodeN1 - op - 1);
+        return;
+    }
+
+    switch (op)
+    {
+        case AVMOpcodeInt8:
+        case AVMOpcodeInt16:
+        case AVMOpcodeInt24:
+        case AVMOpcodeInt32:
+        {
+            int bits = 8 * info->operand_bytes;
+
+            if (bits < 32)
+                v = (uint32_t)((int32_t)(v << (32-bits)) >> (32-bits));
+
+            fprintf(f, "    AVM_NATIVE_OP(%zu, 0x%02x, _avm_native_push(s, AVM_VALUE_FROM_INTEGER(%ld)));\n",
+                    pos, op, (long)(int32_t)v);
+            return;
+        }
+
+        case AVMOpcodeAdd:
+        case AVMOpcodeSub:
+        case AVMOpcodeMul:
+        case AVMOpcodeAnd:
+        case AVMOpcodeOr:
+        case AVMOpcodeEq:
+        case AVMOpcodeNeq:
+        case AVMOpcodeLt:
+        case AVMOpcodeLte:
+        case AVMOpcodeGt:
+        case AVMOpcodeGte:
+            fprintf(f, "    AVM_NATIVE_OP(%zu, 0x%02x, _avm_native_binary(s, 0x%02x));",
+                    pos, op, op);
+            write_name(f, op);
+            return;
+
+        case AVMOpcodeInc:
+        case AVMOpcodeDec:
+        case AVMOpcodeEqZ:
+        case AVMOpcodeNeqZ:
+        case AVMOpcodeNot:
+            fprintf(f, "    AVM_NATIVE_OP(%zu, 0x%02x, _avm_native_unary(s, 0x%02x));",
+                    pos, op, op);
+            write_name(f, op);
+            return;
+
+        case AVMOpcodeDup:
+            fprintf(f, "    AVM_NATIVE_OP(%zu, 0x%02x, _avm_native_dup(s));\n", pos, op);
+            return;
+
+        case AVMOpcodePop:
+            fprintf(f, "    AVM_NATIVE_OP(%zu, 0x%02x, _avm_native_pop(s));\n", pos, op);
+            return;
+
+        case AVMOpcodeSwap:
+            fprintf(f, "    AVM_NATIVE_OP(%zu, 0x%02x, _avm_native_swap(s));\n", pos, op);
+            return;
+
+        default:
+            fprintf(f, "    AVM_NATIVE_OP(%zu, 0x%02x, 0);", pos, op);
+            write_name(f, op);
+            return;
+    }
+}
+
+static int write_block(FILE *f, Program *p, size_t i)
+{
+    const uint8_t *code = p->code + p->blocks[i].start;
+    size_t         end  = p->blocks[i].end - p->blocks[i].start,
+                   pos,
+                   next;
+    char          *insns  = malloc(end + 1),
+                  *labels = calloc(end + 1, 1);
+    char           after_control = 1;
+
+    if (!insns || !labels)
+    {
+        free(insns);
+        free(labels);
+        return 1;
+    }
+
+    mark_insns(code, end, insns);
+
+    /* entries, jump targets and the start, which loops come back to */
+    if (insns[end])
+        labels[0] = 1;
+
+    fprintf(f, "static const uint32_t entries_%zu[] = {", i);
+
+    for (pos=0; pos<end && (next=next_insn(code,pos,end)); pos=next)
+    {
+        AVMOpcode op = code[pos];
+        long      target;
+
+        /* the start, and every instruction after a control opcode but another */
+        if (after_control && !OPCODE_INFO[op].control)
+        {
+            fprintf(f, " %zu,", pos);
+            labels[pos] = 2;
+        }
+
+        if (is_jump(op) && (target = jump_target(code, pos, next, end, insns)) >= 0)
+            labels[target] |= 1;
+
+        after_control = OPCODE_INFO[op].control;
+    }
+
+    fprintf(f, " };\n\n"
+               "static AVMError block_%zu(AVM vm, size_t delta, const void *at)\n"
+               "{\n"
+               "    AVM_NATIVE_BEGIN(_host, %zu)\n\n"
+               "    switch ((uintptr_t)at)\n"
+               "    {\n", i, end);
+
+    for (pos=0;pos<end;++pos)
+    {
+        if (labels[pos] & 2)
+            fprintf(f, "        case %zu: goto L%zu;\n", pos, pos);
+    }
+
+    fprintf(f, "        default: AVM_NATIVE_EXIT((uintptr_t)at);\n"
+               "    }\n\n");
+
+    for (pos=0; pos<end && (next=next_insn(code,pos,end)); pos=next)
+    {
+        if (labels[pos])
+            fprintf(f, "L%zu:\n", pos);
+
+        write_insn(f, code, pos, next, end, insns);
+    }
+
+    /* the end, or the first thing the interpreter must report */
+    if (labels[pos])
+        fprintf(f, "L%zu:\n", pos);
+
+    if (pos == end)
+        fprintf(f, "    AVM_NATIVE_END(%zu, L0);\n", end);
+    else
+        fprintf(f, "    AVM_NATIVE_EXIT(%zu);\n", pos);
+
+    fprintf(f, "}\n\n");
+
+    free(insns);
+    free(labels);
+
+    return 0;
+}
+
+/* blocks too short to be worth entering stay interpreted */
+static int is_worth(Program *p, size_t i)
+{
+    return count_insns(p->code + p->blocks[i].start,
+                       p->blocks[i].end - p->blocks[i].start) >= MIN_BLOCK_INSNS;
+}
+
+static int translate(FILE *f, Program *p, const char *name)
+{
+    size_t i;
+
+    if (add_block(p, 0, p->size))
+        return 1;
+
+    for (i=0;i<p->nblocks;++i)
+    {
+        if (find_blocks(p, i))
+            return 1;
+    }
+
+    fprintf(f, "/* THIS FILE IS AUTOGENERATED FROM %s: DO NOT EDIT */\n\n"
+               "#include \"avm/native.h\"\n\n"
+               "static const AVMNativeHost *_host;\n\n"
+               "static const uint8_t program[] = {", name);
+
+    for (i=0;i<p->size;++i)
+        fprintf(f, "%s0x%02x,", i % 12? " " : "\n    ", p->code[i]);
+
+    fprintf(f, "\n};\n\n");
+
+    for (i=0;i<p->nblocks;++i)
+    {
+        if (!is_worth(p, i))
+            continue;
+
+        if (write_block(f, p, i))
+            return 1;
+
+        p->ntranslated ++;
+    }
+
+    fprintf(f, "static const AVMNativeBlock blocks[] = {\n");
+
+    for (i=0;i<p->nblocks;++i)
+    {
+        if (!is_worth(p, i))
+            continue;
+
+        fprintf(f, "    { program + %zu, %zu, block_%zu, entries_%zu,"
+                   " sizeof(entries_%zu)/sizeof(uint32_t) },\n",
+                p->blocks[i].start, p->blocks[i].end - p->blocks[i].start,
+                i, i, i);
+    }
+
+    fprintf(f, "    { program, 0, NULL, NULL, 0 }\n"
+               "};\n\n"
+               "const AVMNativeModule avm_native_module = {\n"
+               "    AVM_VERSION, AVM_NATIVE_ABI, &_host,\n"
+               "    blocks, sizeof(blocks)/sizeof(blocks[0]) - 1\n"
+               "};\n");
+
+    return 0;
+}
+
+static char* read_file(const char *name, size_t *size)
+{
+    FILE *f = fopen(name, "rb");
+    char *data;
+    long  len;
+
+    if (f == NULL)
+        return NULL;
+
+    if (fseek(f, 0, SEEK_END) || (len = ftell(f)) < 0 || fseek(f, 0, SEEK_SET)
+     || (data = malloc(len + 1)) == NULL)
+    {
+        fclose(f);
+        return NULL;
+    }
+
+    if (fread(data, 1, len, f) != (size_t)len)
+    {
+        free(data);
+        data = NULL;
+    }
+
+    *size = len;
+
+    fclose(f);
+    return data;
+}
+
+int main(int argc, char *argv[])
+{
+    Program p;
+    FILE   *fout;
+    int     ret;
+
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <input file> <output file>\n", argv[0]);
+        return 1;
+    }
+
+    memset(&p, 0, sizeof(p));
+
+    if ((p.code = (const uint8_t*)read_file(argv[1], &p.size)) == NULL)
+    {
+        fprintf(stderr,"%s: Unable to open input '%s' for reading\n",
+                argv[0], argv[1]);
+        return 3;
+    }
+
+    if ((fout = fopen(argv[2], "w")) == NULL)
+    {
+        fprintf(stderr,"%s: Unable to open output '%s' for writing\n",
+                argv[0], argv[2]);
+        return 4;
+    }
+
+    ret = translate(fout, &p, argv[1]);
+
+    if (ret)
+        fprintf(stderr, "%s: Out of memory\n", argv[0]);
+    else
+        fprintf(stderr, "Translated %zu blocks of %zu bytes\n", p.ntranslated, p.size);
+
+    fclose(fout);
+    free((void*)p.code);
+    free(p.blocks);
+
+    return ret;
+}
@@ -31,6 +31,15 @@ Buffer *buffer_init()
     exit(7);
 }
 
+void buffer_free(Buffer *b)
+{
+    if (b)
+    {
+        free(b->data);
+        free(b);
+    }
+}
+
 void buffer_append(Buffer *b, const char *data, size_t size)
 {
     size_t want = b->used + size;
@@ -11,6 +11,7 @@
 
 #include <avm/generated/opcodes.h>
 #include <avm/generated/opcode-name-table.h>
+#include <avm/generated/superinstruction-table.h>
 
 static AVM g_avm;
 
@@ -128,27 +129,112 @@ int compile_string(Buffer *output, Buffer *token)
     return 0;
 }
 
-int compile_op(Buffer *output, Buffer *token)
+int find_op(const char *op)
 {
-    char buf[1];
-
-    const char *op = buffer_get_data(token);
-    
     size_t i;
     for (i=0;OPCODE_TABLE[i].name != NULL;++i)
     {
         if (!strcasecmp(OPCODE_TABLE[i].name,op))
         {
-            buf[0] = OPCODE_TABLE[i].op;
-            buffer_append(output,buf,1);
-            return 0;
+            return OPCODE_TABLE[i].op;
         }
     }
 
+    return -1;
+}
+
+/* registers and locals are numbered in the mnemonic: rget3, lset0 */
+int slot_op_limit(int code)
+{
+    switch (code)
+    {
+        case AVMOpcodeRSet:
+        case AVMOpcodeRGet:
+        case AVMOpcodeRInc:
+            return AVM_REGISTERS-1;
+
+        case AVMOpcodeLSet:
+        case AVMOpcodeLGet:
+        case AVMOpcodeLInc:
+            return UINT8_MAX;
+
+        default:
+            return -1;
+    }
+}
+
+int compile_slot_op(Buffer *output, const char *op)
+{
+    char   buf[2],
+           name[8],
+          *endp;
+    size_t len = strcspn(op, "0123456789");
+    long   n;
+    int    code;
+
+    if (len == 0 || len >= sizeof(name) || op[len] == '\0')
+        return -1;
+
+    memcpy(name, op, len);
+    name[len] = '\0';
+
+    if (slot_op_limit(code = find_op(name)) < 0)
+        return -1;
+
+    n = strtol(&op[len], &endp, 10);
+
+    if (*endp != '\0' || n > slot_op_limit(code))
+    {
+        fprintf(stderr, "Invalid slot: %s\n", op);
+        return 1;
+    }
+
+    buf[0] = code;
+    buf[1] = n;
+    buffer_append(output, buf, 2);
+
+    return 0;
+}
+
+int compile_op(Buffer *output, Buffer *token)
+{
+    char buf[1];
+
+    const char *op = buffer_get_data(token);
+    int         code = find_op(op);
+
+    if (code >= 0 && slot_op_limit(code) >= 0)
+    {
+        fprintf(stderr, "Missing slot number: %s\n", op);
+        return 1;
+    }
+
+    if (code >= 0)
+    {
+        buf[0] = code;
+        buffer_append(output,buf,1);
+        return 0;
+    }
+
+    if ((code = compile_slot_op(output, op)) >= 0)
+        return code;
+
     fprintf(stderr, "Invalid opcode: %s\n", op);
     return 0;
 }
 
+int compile_jump(Buffer *output, AVMOpcode op, uint32_t offset)
+{
+    char buf[3];
+
+    buf[0] = op;
+    buf[1] = 0xff & (offset>>8);
+    buf[2] = 0xff & offset;
+    buffer_append(output, buf, 3);
+
+    return 0;
+}
+
 int compile_code(Buffer *output, Buffer *code)
 {
     char buf[5];
@@ -209,12 +295,388 @@ int compile_ref(Buffer *output, Buffer *token, TokenType type)
     return 0;
 }
 
-int compile_nested(Buffer *output, FILE *input, int nestlvl)
+/*
+ * =name stores into a local, declared by the first store into it and seen
+ * by the blocks nested in it, where $name then reads it. A block compiled
+ * inline uses the window of the block it is in; any other one runs with a
+ * window of its own, numbered from 0, and can't see the locals outside it.
+ *
+ * Which a block is only shows once it's compiled, so until then locals
+ * are compiled as ids, unique among the blocks being compiled, and where
+ * they are is kept: slots are numbered when a block is emitted as code,
+ * and for the program at its end.
+ */
+#define MAX_LOCALS 256
+#define NO_LGET    ((size_t)-1)
+
+/* the locals of the window of a block being compiled */
+typedef struct
+{
+    char    declared[MAX_LOCALS]; /* by id */
+    Buffer *operands;             /* offsets of their ids in the block */
+} Locals;
+
+typedef struct Scope
+{
+    struct Scope *parent;
+    Locals       *locals;
+    char         *names[MAX_LOCALS];
+    int           ids[MAX_LOCALS];
+    int           count;
+    size_t        lget; /* output position of the last LGet, for LInc */
+} Scope;
+
+static char *g_local_names[MAX_LOCALS]; /* by id, while in use */
+
+Locals *locals_init()
+{
+    Locals *l = calloc(1, sizeof(Locals));
+
+    l->operands = buffer_init();
+    return l;
+}
+
+void locals_free(Locals *l)
+{
+    if (l)
+    {
+        buffer_free(l->operands);
+        free(l);
+    }
+}
+
+void locals_add_operand(Locals *l, size_t at)
+{
+    buffer_append(l->operands, (const char*)&at, sizeof(at));
+}
+
+/* a block compiled inline at offset base joins the window of to */
+void locals_merge(Locals *to, Locals *from, size_t base)
+{
+    size_t *at = (size_t*)buffer_get_data(from->operands),
+            n  = buffer_get_size(from->operands) / sizeof(*at),
+            i;
+
+    for (i=0;i<MAX_LOCALS;++i)
+    {
+        to->declared[i] |= from->declared[i];
+    }
+
+    for (i=0;i<n;++i)
+    {
+        locals_add_operand(to, base + at[i]);
+    }
+}
+
+/* numbers the slots of a block with a window of its own, freeing its ids */
+int compile_window(Buffer *code, Locals *l)
+{
+    unsigned char *data = (unsigned char*)buffer_get_data(code);
+    size_t        *at   = (size_t*)buffer_get_data(l->operands),
+                   n    = buffer_get_size(l->operands) / sizeof(*at),
+                   i;
+    int            slots[MAX_LOCALS],
+                   count = 0,
+                   rv    = 0;
+
+    for (i=0;i<MAX_LOCALS;++i)
+    {
+        slots[i] = -1;
+    }
+
+    for (i=0;i<n && !rv;++i)
+    {
+        int id = data[at[i]];
+
+        if (!l->declared[id])
+        {
+            fprintf(stderr, "Local %s used in a block that doesn't run inline\n",
+                    g_local_names[id]);
+            rv = 1;
+        }
+        else
+        {
+            if (slots[id] < 0)
+                slots[id] = count++;
+
+            data[at[i]] = slots[id];
+        }
+    }
+
+    for (i=0;i<MAX_LOCALS;++i)
+    {
+        if (l->declared[i])
+        {
+            free(g_local_names[i]);
+            g_local_names[i] = NULL;
+        }
+    }
+
+    return rv;
+}
+
+int find_local(Scope *scope, const char *name)
+{
+    int i;
+
+    for (;scope != NULL;scope=scope->parent)
+    {
+        for (i=0;i<scope->count;++i)
+        {
+            if (!strcmp(scope->names[i], name))
+                return scope->ids[i];
+        }
+    }
+
+    return -1;
+}
+
+int compile_local(Buffer *output, Scope *scope, Buffer *token, TokenType type)
+{
+    char buf[2];
+    int  id = find_local(scope, buffer_get_data(token));
+
+    if (id < 0)
+    {
+        if (type == TokenDeref)
+            return compile_ref(output, token, type);
+
+        for (id=0;id<MAX_LOCALS && g_local_names[id];++id)
+            ;
+
+        if (id == MAX_LOCALS || scope->count == MAX_LOCALS)
+        {
+            fprintf(stderr, "Too many locals: %s\n", buffer_get_data(token));
+            return 1;
+        }
+
+        g_local_names[id] = strdup(buffer_get_data(token));
+
+        scope->names[scope->count] = g_local_names[id];
+        scope->ids[scope->count]   = id;
+        scope->count ++;
+
+        scope->locals->declared[id] = 1;
+    }
+
+    buf[0] = (type == TokenDeref)? AVMOpcodeLGet : AVMOpcodeLSet;
+    buf[1] = id;
+
+    /* $name inc =name, keeping the operand of the LGet */
+    if (type == TokenLocal
+     && scope->lget != NO_LGET
+     && scope->lget + 3 == buffer_get_size(output)
+     && (uint8_t)buffer_get_data(output)[scope->lget+1] == id
+     && buffer_get_data(output)[scope->lget+2] == AVMOpcodeInc)
+    {
+        buffer_truncate(output, scope->lget);
+        buf[0] = AVMOpcodeLInc;
+    }
+    else
+    {
+        locals_add_operand(scope->locals, buffer_get_size(output) + 1);
+    }
+
+    scope->lget = (type == TokenDeref)? buffer_get_size(output) : NO_LGET;
+
+    buffer_append(output, buf, 2);
+    return 0;
+}
+
+/*
+ * Runs of opcodes without operands are compiled as they come, then
+ * rewritten with superinstructions once something else follows; a run
+ * never spans a jump target, as jumps and the code they jump over end
+ * one.
+ */
+#define NO_RUN ((size_t)-1)
+
+/* the opcode a token compiles to when it is one byte, or -1 */
+int run_op(Buffer *token, TokenType type)
+{
+    long long rval;
+    char     *endp;
+    int       op;
+
+    switch (type)
+    {
+        case TokenOp:
+            op = find_op(buffer_get_data(token));
+            return slot_op_limit(op) < 0? op : -1;
+
+        case TokenNumber:
+            rval = strtoll(buffer_get_data(token), &endp, 0);
+
+            if (*endp != '\0' || rval < -7 || rval > 7)
+                return -1;
+
+            return rval >= 0? AVMOpcode0 + rval : AVMOpcodeN1 - rval - 1;
+
+        default:
+            return -1;
+    }
+}
+
+/* fuses output from start, the longest superinstruction first */
+void compile_run(Buffer *output, size_t start)
+{
+    unsigned char *code = (unsigned char*)buffer_get_data(output);
+    size_t         end  = buffer_get_size(output),
+                   in   = start,
+                   out  = start;
+
+    while (in < end)
+    {
+        int i, k, best = -1;
+
+        for (i=0;SUPERINSTRUCTION_TABLE[i].length;++i)
+        {
+            int length = SUPERINSTRUCTION_TABLE[i].length;
+
+            if (in + length > end
+             || (best >= 0 && length <= SUPERINSTRUCTION_TABLE[best].length))
+                continue;
+
+            for (k=0;k<length && code[in+k] == SUPERINSTRUCTION_TABLE[i].ops[k];++k)
+                ;
+
+            if (k == length)
+                best = i;
+        }
+
+        if (best >= 0)
+        {
+            code[out++] = SUPERINSTRUCTION_TABLE[best].op;
+            in += SUPERINSTRUCTION_TABLE[best].length;
+        }
+        else
+        {
+            code[out++] = code[in++];
+        }
+    }
+
+    buffer_truncate(output, out);
+}
+
+/*
+ * Code blocks are held back until the next token shows how they are used:
+ * blocks consumed by if, ifelse, repeat or for are compiled inline as
+ * jumps and loops instead of being pushed as code objects.
+ */
+#define MAX_PENDING_BLOCKS 2
+
+typedef struct
+{
+    Buffer *blocks[MAX_PENDING_BLOCKS];
+    Locals *locals[MAX_PENDING_BLOCKS];
+    int     count;
+} PendingBlocks;
+
+/* emits the first n pending blocks as code objects */
+int compile_pending(Buffer *output, PendingBlocks *pending, int n)
+{
+    int i, rv = 0;
+
+    for (i=0;i<pending->count;++i)
+    {
+        if (i < n)
+        {
+            if (!rv)
+                rv = compile_window(pending->blocks[i], pending->locals[i]);
+            if (!rv)
+                rv = compile_code(output, pending->blocks[i]);
+            buffer_free(pending->blocks[i]);
+            locals_free(pending->locals[i]);
+        }
+        else
+        {
+            pending->blocks[i-n] = pending->blocks[i];
+            pending->locals[i-n] = pending->locals[i];
+        }
+    }
+
+    pending->count = n < pending->count? pending->count - n : 0;
+    return rv;
+}
+
+/* returns 1 when op consumed the pending blocks, setting *rv on errors */
+int compile_control(Buffer *output, Locals *locals, PendingBlocks *pending,
+                    Buffer *token, int *rv)
+{
+    int     op     = find_op(buffer_get_data(token));
+    Buffer *body   = pending->blocks[pending->count-1];
+    Locals *window = pending->locals[pending->count-1];
+    size_t  len    = buffer_get_size(body);
+
+    switch (op)
+    {
+        case AVMOpcodeIf:
+            if (len > INT16_MAX)
+                return 0;
+
+            *rv = compile_pending(output, pending, pending->count-1);
+            compile_jump(output, AVMOpcodeJmpZ, len);
+            break;
+
+        case AVMOpcodeIfElse:
+        {
+            if (pending->count < 2)
+                return 0;
+
+            Buffer *then = pending->blocks[0];
+
+            if (len > INT16_MAX || buffer_get_size(then) + 3 > INT16_MAX)
+                return 0;
+
+            compile_jump(output, AVMOpcodeJmpZ, buffer_get_size(then) + 3);
+            locals_merge(locals, pending->locals[0], buffer_get_size(output));
+            buffer_append_buffer(output, then);
+            compile_jump(output, AVMOpcodeJmp, len);
+            buffer_free(then);
+            locals_free(pending->locals[0]);
+        }
+        break;
+
+        case AVMOpcodeRepeat:
+        case AVMOpcodeFor:
+            if (len > UINT16_MAX)
+                return 0;
+
+            *rv = compile_pending(output, pending, pending->count-1);
+            compile_jump(output,
+                         op == AVMOpcodeFor? AVMOpcodeLoopFor : AVMOpcodeLoopRepeat,
+                         len);
+            break;
+
+        default:
+            return 0;
+    }
+
+    locals_merge(locals, window, buffer_get_size(output));
+    buffer_append_buffer(output, body);
+    buffer_free(body);
+    locals_free(window);
+    pending->count = 0;
+
+    return 1;
+}
+
+int compile_nested(Buffer *output, Locals *locals, FILE *input, int nestlvl, Scope *parent)
 {
-    TokenType type;
-    Buffer   *token = buffer_init();
+    TokenType     type;
+    Buffer       *token = buffer_init();
+    PendingBlocks pending;
+    Scope         scope;
+    size_t        run = NO_RUN;
     
-    int rv = 0;
+    int rv = 0, op;
+
+    pending.count = 0;
+
+    scope.parent = parent;
+    scope.locals = locals;
+    scope.count  = 0;
+    scope.lget   = NO_LGET;
 
     while (rv==0 && parse_input(token, &type, input) 
        && type != TokenError
@@ -223,6 +685,32 @@ int compile_nested(Buffer *output, FILE *input, int nestlvl)
         
         buffer_zero_terminate(token);
 
+        op = pending.count > 0? -1 : run_op(token, type);
+
+        if (op < 0 && run != NO_RUN)
+        {
+            compile_run(output, run);
+            run = NO_RUN;
+        }
+        else if (op >= 0 && run == NO_RUN)
+        {
+            run = buffer_get_size(output);
+        }
+
+        if (pending.count > 0)
+        {
+            if (type == TokenOp && compile_control(output, locals, &pending, token, &rv))
+                continue;
+
+            if (type != TokenCodeBegin)
+                rv = compile_pending(output, &pending, pending.count);
+            else if (pending.count == MAX_PENDING_BLOCKS)
+                rv = compile_pending(output, &pending, 1);
+
+            if (rv)
+                break;
+        }
+
         switch (type)
         {
             case TokenNumber:
@@ -238,17 +726,28 @@ int compile_nested(Buffer *output, FILE *input, int nestlvl)
                 break;
 
             case TokenRef:
-            case TokenDeref:
                 rv = compile_ref(output, token, type);
                 break;
 
+            case TokenDeref:
+            case TokenLocal:
+                rv = compile_local(output, &scope, token, type);
+                break;
+
             case TokenCodeBegin:
             {
                 Buffer *subroutine = buffer_init();
-                rv                 = compile_nested(subroutine, input, nestlvl+1);
+                Locals *window     = locals_init();
+                rv                 = compile_nested(subroutine, window, input, nestlvl+1, &scope);
                 if (!rv)
                 {
-                    rv = compile_code(output, subroutine);
+                    pending.blocks[pending.count]   = subroutine;
+                    pending.locals[pending.count++] = window;
+                }
+                else
+                {
+                    buffer_free(subroutine);
+                    locals_free(window);
                 }
             }
             break;
@@ -274,6 +773,13 @@ int compile_nested(Buffer *output, FILE *input, int nestlvl)
         }
     }
 term:
+    if (run != NO_RUN)
+        compile_run(output, run);
+
+    if (!rv)
+        rv = compile_pending(output, &pending, pending.count);
+
+    buffer_free(token);
 
     return rv? rv : type != TokenError ? 0 : 9;
 }
@@ -306,9 +812,15 @@ int compile(Args *args)
         return 12;
     }
 
-    Buffer *buf = buffer_init();
+    Buffer *buf    = buffer_init();
+    Locals *locals = locals_init();
+
+    ret = compile_nested(buf, locals, fin, 0, NULL);
+
+    if (!ret)
+        ret = compile_window(buf, locals);
 
-    ret = compile_nested(buf, fin, 0);
+    locals_free(locals);
 
     if (!ret)
     {
@@ -195,6 +195,10 @@ char parse_input(Buffer *token, TokenType *pType, FILE *input)
             *pType = c == '@'? TokenRef : TokenDeref;
             return parse_ref(token, pType, input);
 
+        case '=':
+            *pType = TokenLocal;
+            return parse_ref(token, pType, input);
+
         case '{':
             *pType = TokenCodeBegin;
             return 1;
@@ -10,6 +10,7 @@ typedef enum TokenType
     TokenChar,
     TokenRef,
     TokenDeref,
+    TokenLocal,
     TokenCodeBegin,
     TokenCodeEnd,
     TokenOp,